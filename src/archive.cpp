@@ -20,14 +20,18 @@
 #include "config.hpp"
 #include "errors.hpp"
 #include "filesystem.hpp"
+#include "hash.hpp"
 #include "index.hpp"
 #include "path.hpp"
 #include "reapack.hpp"
 #include "transaction.hpp"
 #include "win32.hpp"
 
+#include <cctype>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <set>
 #include <sstream>
 
 #include <zlib/zip.h>
@@ -37,7 +41,11 @@
 using namespace std;
 
 static const Path ARCHIVE_TOC("toc");
-static const size_t BUFFER_SIZE = 4096;
+
+static size_t bufferSize()
+{
+  return (size_t)g_reapack->config()->archive.bufferSize * 1024;
+}
 
 #ifdef _WIN32
 static void *wide_fopen(voidpf, const void *filename, int mode)
@@ -62,20 +70,33 @@ static void *wide_fopen(voidpf, const void *filename, int mode)
 }
 #endif
 
+static zipFile openReader(const Path &path)
+{
+  zlib_filefunc64_def filefunc;
+  fill_fopen64_filefunc(&filefunc);
+#ifdef _WIN32
+  filefunc.zopen64_file = wide_fopen;
+#endif
+
+  return unzOpen2_64(path.join().c_str(), &filefunc);
+}
+
 struct ImportArchive {
+  void importBase(const string &, const Path &dir);
   void importRemote(const string &);
   void importPackage(const string &);
+  void queueRemote();
 
+  string m_path;
   ArchiveReaderPtr m_reader;
-  RemoteList *m_remotes;
   Transaction *m_tx;
-  IndexPtr m_lastIndex;
+  Remote m_remote;
+  vector<string> m_packages;
 };
 
 void Archive::import(const string &path)
 {
-  ImportArchive state{make_shared<ArchiveReader>(path),
-    &g_reapack->config()->remotes};
+  ImportArchive state{path, make_shared<ArchiveReader>(path)};
 
   stringstream toc;
   if(const int err = state.m_reader->extractFile(ARCHIVE_TOC, toc))
@@ -95,6 +116,9 @@ void Archive::import(const string &path)
 
     try {
       switch(line[0]) {
+      case 'B':
+        state.importBase(data, Path(path).dirname());
+        break;
       case 'R':
         state.importRemote(data);
         break;
@@ -111,113 +135,230 @@ void Archive::import(const string &path)
     }
   }
 
-  g_reapack->config()->write();
+  state.queueRemote();
   state.m_tx->runTasks();
 }
-
-void ImportArchive::importRemote(const string &data)
+void ImportArchive::importBase(const string &data, const Path &dir)
 {
-  m_lastIndex = nullptr; // clear the previous repository
-  Remote remote = Remote::fromString(data);
+  string name;
+  istringstream(data) >> quoted(name);
 
-  if(const int err = m_reader->extractFile(Index::pathFor(remote.name()))) {
-    throw reapack_error(String::format("Failed to extract index of %s (%d)",
-      remote.name().c_str(), err));
-  }
+  // the base may itself be an incremental archive
+  ArchiveReaderPtr reader = m_reader;
+  set<string> visited;
+
+  while(!name.empty() && visited.insert(name).second) {
+    const Path &path = dir + name;
+    ArchiveReaderPtr base;
+
+    try {
+      base = make_shared<ArchiveReader>(path);
+    }
+    catch(const reapack_error &e) {
+      throw reapack_error(String::format("Cannot open the base archive %s: %s",
+        path.join().c_str(), e.what()));
+    }
+
+    reader->setBase(base);
+    reader = base;
+    name.clear();
 
-  const Remote &original = m_remotes->get(remote.name());
-  if(original.isProtected()) {
-    remote.setUrl(original.url());
-    remote.protect();
+    stringstream toc;
+    string line;
+    if(!base->extractFile(ARCHIVE_TOC, toc) && getline(toc, line) &&
+        line.compare(0, 5, "BASE ") == 0)
+      istringstream(line.substr(5)) >> quoted(name);
   }
+}
 
-  m_remotes->add(remote);
-  m_lastIndex = Index::load(remote.name());
+void ImportArchive::importRemote(const string &data)
+{
+  queueRemote(); // finish the previous repository
+  m_remote = Remote::fromString(data);
 }
 
 void ImportArchive::importPackage(const string &data)
 {
-  // don't report an error if the index isn't loaded assuming we already
-  // did when failing to import the repository above
-  if(!m_lastIndex)
-    return;
+  // don't report an error if the repository is invalid assuming we already
+  // did when failing to import it above
+  if(m_remote)
+    m_packages.push_back(data);
+}
 
-  string categoryName, packageName, versionName;
-  bool pinned;
+void ImportArchive::queueRemote()
+{
+  // the index is extracted and loaded in a worker thread and the packages
+  // are queued for installation as soon as it is ready
+  if(m_remote)
+    m_tx->importRemote(m_remote, m_packages, m_reader, m_path);
 
-  istringstream stream(data);
-  stream
-    >> quoted(categoryName) >> quoted(packageName) >> quoted(versionName)
-    >> pinned;
+  m_remote = {};
+  m_packages.clear();
+}
 
-  const Package *pkg = m_lastIndex->find(categoryName, packageName);
-  const Version *ver = pkg ? pkg->findVersion(versionName) : nullptr;
+ArchiveReader::ArchiveReader(const Path &path)
+  : m_path(path)
+{
+  zipFile zip = openReader(path);
 
-  if(!ver) {
-    throw reapack_error(String::format(
-      "%s/%s/%s v%s cannot be found or is incompatible with your operating system.",
-      m_lastIndex->name().c_str(), categoryName.c_str(),
-      packageName.c_str(), versionName.c_str()));
+  if(!zip)
+    throw reapack_error(FS::lastError());
+
+  m_handles.push_back(zip);
+  readDirectory(zip);
+}
+
+ArchiveReader::~ArchiveReader()
+{
+  for(zipFile zip : m_handles)
+    unzClose(zip);
+}
+
+void ArchiveReader::readDirectory(zipFile zip)
+{
+  unz_file_info64 info;
+  unz64_file_pos pos;
+  string name;
+
+  for(int status = unzGoToFirstFile(zip); status == UNZ_OK;
+      status = unzGoToNextFile(zip)) {
+    if(unzGetCurrentFileInfo64(zip, &info, nullptr, 0,
+        nullptr, 0, nullptr, 0) != UNZ_OK)
+      continue;
+
+    name.resize(info.size_filename);
+    if(unzGetCurrentFileInfo64(zip, &info, &name[0], (uLong)name.size(),
+        nullptr, 0, nullptr, 0) != UNZ_OK)
+      continue;
+
+    if(unzGetFilePos64(zip, &pos) == UNZ_OK)
+      m_directory.insert({name, {pos.pos_in_zip_directory, pos.num_of_file}});
   }
+}
+
+int ArchiveReader::locateFile(zipFile zip, const Path &path) const noexcept
+{
+  const string &name = path.join(false);
+  const auto it = m_directory.find(name);
 
-  m_tx->install(ver, pinned, m_reader);
+  if(it == m_directory.end()) {
+    // let minizip handle eventual case differences
+    return unzLocateFile(zip, name.c_str(), false);
+  }
+
+  const unz64_file_pos pos{it->second.directoryOffset, it->second.index};
+  return unzGoToFilePos64(zip, &pos);
 }
 
-ArchiveReader::ArchiveReader(const Path &path)
+zipFile ArchiveReader::acquireHandle() noexcept
 {
-  zlib_filefunc64_def filefunc;
-  fill_fopen64_filefunc(&filefunc);
-#ifdef _WIN32
-  filefunc.zopen64_file = wide_fopen;
-#endif
+  {
+    WDL_MutexLock lock(&m_mutex);
+
+    if(!m_handles.empty()) {
+      zipFile zip = m_handles.back();
+      m_handles.pop_back();
+      return zip;
+    }
+  }
 
-  m_zip = unzOpen2_64(path.join().c_str(), &filefunc);
+  return openReader(m_path);
+}
 
-  if(!m_zip)
-    throw reapack_error(FS::lastError());
+void ArchiveReader::releaseHandle(zipFile zip) noexcept
+{
+  WDL_MutexLock lock(&m_mutex);
+  m_handles.push_back(zip);
 }
 
-ArchiveReader::~ArchiveReader()
+// Creates a file for writing large chunks directly without buffering them.
+static FILE *createFile(const Path &path)
 {
-  unzClose(m_zip);
+  FILE *file = FS::create(path);
+
+  if(file)
+    setvbuf(file, nullptr, _IONBF, 0);
+
+  return file;
 }
 
 int ArchiveReader::extractFile(const Path &path)
 {
-  ofstream stream;
+  FILE *file = createFile(path);
 
-  if(FS::open(stream, path))
-    return extractFile(path, stream);
-  else {
+  if(!file) {
     throw reapack_error(String::format("%s: %s",
       path.join().c_str(), FS::lastError()));
   }
+
+  const int status = extractFile(path, file);
+  fclose(file);
+
+  return status;
 }
 
-int ArchiveReader::extractFile(const Path &path, ostream &stream) noexcept
+static int extractEntry(zipFile zip, ostream *stream, FILE *file)
 {
-  int status = unzLocateFile(m_zip, path.join(false).c_str(), false);
-  if(status != UNZ_OK)
-    return status;
+  if(file) {
+    unz_file_info64 info;
+    if(unzGetCurrentFileInfo64(zip, &info, nullptr, 0,
+        nullptr, 0, nullptr, 0) == UNZ_OK)
+      FS::allocate(file, (int64_t)info.uncompressed_size);
+  }
 
-  status = unzOpenCurrentFile(m_zip);
+  const int status = unzOpenCurrentFile(zip);
   if(status != UNZ_OK)
     return status;
 
-  string buffer(BUFFER_SIZE, 0);
+  string buffer(bufferSize(), 0);
 
   const auto readChunk = [&] {
-    return unzReadCurrentFile(m_zip, &buffer[0], (int)buffer.size());
+    return unzReadCurrentFile(zip, &buffer[0], (int)buffer.size());
   };
 
   while(const int len = readChunk()) {
-    if(len < 0)
+    if(len < 0) {
+      unzCloseCurrentFile(zip);
       return len; // read error
+    }
 
-    stream.write(&buffer[0], len);
+    if(!file)
+      stream->write(&buffer[0], len);
+    else if(fwrite(&buffer[0], 1, len, file) != (size_t)len) {
+      unzCloseCurrentFile(zip);
+      return UNZ_ERRNO;
+    }
   }
 
-  return unzCloseCurrentFile(m_zip);
+  return unzCloseCurrentFile(zip);
+}
+
+int ArchiveReader::extractFile(const Path &path, ostream &stream) noexcept
+{
+  return extract(path, &stream, nullptr);
+}
+
+int ArchiveReader::extractFile(const Path &path, FILE *file) noexcept
+{
+  return extract(path, nullptr, file);
+}
+
+int ArchiveReader::extract(const Path &path, ostream *stream, FILE *file) noexcept
+{
+  zipFile zip = acquireHandle();
+  if(!zip)
+    return UNZ_ERRNO;
+
+  int status = locateFile(zip, path);
+  if(status == UNZ_OK)
+    status = extractEntry(zip, stream, file);
+
+  releaseHandle(zip);
+
+  if(status == UNZ_END_OF_LIST_OF_FILE && m_base)
+    return m_base->extract(path, stream, file);
+
+  return status;
 }
 
 FileExtractor::FileExtractor(const Path &target, const ArchiveReaderPtr &reader)
@@ -228,14 +369,14 @@ FileExtractor::FileExtractor(const Path &target, const ArchiveReaderPtr &reader)
 
 bool FileExtractor::run()
 {
-  ofstream stream;
-  if(!FS::open(stream, m_path.temp())) {
+  FILE *file = createFile(m_path.temp());
+  if(!file) {
     setError({FS::lastError(), m_path.temp().join()});
     return false;
   }
 
-  const int error = m_reader->extractFile(m_path.target(), stream);
-  stream.close();
+  const int error = m_reader->extractFile(m_path.target(), file);
+  fclose(file);
 
   if(error) {
     setError({String::format("Failed to extract file (%d)", error),
@@ -246,7 +387,119 @@ bool FileExtractor::run()
   return true;
 }
 
-ArchiveWriter::ArchiveWriter(const Path &path)
+IndexExtractor::IndexExtractor(const string &remote,
+    const ArchiveReaderPtr &reader)
+  : m_remote(remote), m_reader(reader)
+{
+  setSummary("Extracting %s: " + Index::pathFor(remote).join());
+}
+
+bool IndexExtractor::run()
+{
+  const Path &path = Index::pathFor(m_remote);
+
+  FILE *file = createFile(path);
+  if(!file) {
+    setError({FS::lastError(), path.join()});
+    return false;
+  }
+
+  const int error = m_reader->extractFile(path, file);
+  fclose(file);
+
+  if(error) {
+    setError({String::format("Failed to extract index of %s (%d)",
+      m_remote.c_str(), error), path.join()});
+    return false;
+  }
+
+  try {
+    m_index = Index::load(m_remote);
+  }
+  catch(const reapack_error &e) {
+    setError({e.what(), path.join()});
+    return false;
+  }
+
+  return true;
+}
+
+// Entries bigger than this are deflated into a temporary file
+static const size_t MAX_ENTRY_MEMORY = 8 * 1024 * 1024;
+// Finished entries waiting for the previous ones to be written
+static const size_t MAX_PENDING_MEMORY = 64 * 1024 * 1024;
+
+ArchiveWriter::EntryData::EntryData(const Path &spillPath)
+  : m_spillPath(spillPath), m_file(nullptr), m_spilled(false)
+{
+}
+
+ArchiveWriter::EntryData::EntryData(EntryData &&other)
+  : m_spillPath(move(other.m_spillPath)), m_memory(move(other.m_memory)),
+    m_file(other.m_file), m_spilled(other.m_spilled)
+{
+  other.m_file = nullptr;
+  other.m_spilled = false;
+}
+
+ArchiveWriter::EntryData::~EntryData()
+{
+  if(m_file)
+    fclose(m_file);
+
+  if(m_spilled)
+    FS::remove(m_spillPath);
+}
+
+bool ArchiveWriter::EntryData::append(const char *data, const size_t len)
+{
+  if(!m_spilled && m_memory.size() + len > MAX_ENTRY_MEMORY && !spill())
+    return false;
+
+  if(m_spilled)
+    return fwrite(data, 1, len, m_file) == len;
+
+  m_memory.append(data, len);
+  return true;
+}
+
+bool ArchiveWriter::EntryData::spill()
+{
+  if(m_spilled)
+    return true;
+  else if(m_spillPath.empty())
+    return false;
+
+  m_file = FS::create(m_spillPath);
+  if(!m_file)
+    return false;
+
+  m_spilled = true;
+
+  const bool ok = fwrite(m_memory.data(), 1, m_memory.size(), m_file)
+    == m_memory.size();
+
+  string().swap(m_memory);
+  return ok;
+}
+
+// The spill file is created write-only, and can't be opened a second time
+// while it is open on Windows.
+FILE *ArchiveWriter::EntryData::reopen()
+{
+  if(!m_spilled)
+    return nullptr;
+
+  if(m_file)
+    fclose(m_file);
+
+  m_file = FS::open(m_spillPath);
+  return m_file;
+}
+
+ArchiveWriter::ArchiveWriter(const Path &path, const int level)
+  : m_path(path), m_level(level), m_nextTicket(0), m_nextWrite(0),
+    m_pendingMemory(0), m_error(ZIP_OK)
 {
   zlib_filefunc64_def filefunc;
   fill_fopen64_filefunc(&filefunc);
@@ -279,13 +532,15 @@ int ArchiveWriter::addFile(const Path &path)
 
 int ArchiveWriter::addFile(const Path &path, istream &stream) noexcept
 {
+  WDL_MutexLock lock(&m_mutex);
+
   const int status = zipOpenNewFileInZip(m_zip, path.join(false).c_str(), nullptr,
-    nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_DEFAULT_COMPRESSION);
+    nullptr, 0, nullptr, 0, nullptr, m_level ? Z_DEFLATED : 0, m_level);
 
   if(status != ZIP_OK)
     return status;
 
-  string buffer(BUFFER_SIZE, 0);
+  string buffer(bufferSize(), 0);
 
   const auto readChunk = [&] {
     stream.read(&buffer[0], buffer.size());
@@ -302,29 +557,271 @@ int ArchiveWriter::addFile(const Path &path, istream &stream) noexcept
   return zipCloseFileInZip(m_zip);
 }
 
-FileCompressor::FileCompressor(const Path &target, const ArchiveWriterPtr &writer)
-  : m_path(target), m_writer(writer)
+size_t ArchiveWriter::reserveEntry()
+{
+  WDL_MutexLock lock(&m_mutex);
+  return m_nextTicket++;
+}
+
+Path ArchiveWriter::spillPath(const size_t ticket) const
+{
+  Path path = m_path;
+  path[path.size() - 1] += "." + to_string(ticket);
+  return path;
+}
+
+void ArchiveWriter::addEntry(const size_t ticket, const Path &path,
+  EntryData &&data, const unsigned long crc, const uint64_t size,
+  const int level) noexcept
+{
+  setEntry(ticket, {path, move(data), crc, size, level, false});
+}
+
+void ArchiveWriter::skipEntry(const size_t ticket) noexcept
+{
+  setEntry(ticket, {{}, {}, 0, 0, 0, true});
+}
+
+void ArchiveWriter::setEntry(const size_t ticket, Entry &&entry) noexcept
+{
+  WDL_MutexLock lock(&m_mutex);
+
+  // don't let entries finished ahead of a slow one pile up in memory
+  if(ticket != m_nextWrite &&
+      m_pendingMemory + entry.data.memoryUsage() > MAX_PENDING_MEMORY)
+    entry.data.spill();
+
+  m_pendingMemory += entry.data.memoryUsage();
+  m_pending.emplace(ticket, move(entry));
+
+  // write every entry that is ready, in order
+  for(auto it = m_pending.begin();
+      it != m_pending.end() && it->first == m_nextWrite;
+      it = m_pending.erase(it), ++m_nextWrite) {
+    m_pendingMemory -= it->second.data.memoryUsage();
+
+    if(it->second.skip)
+      continue;
+
+    const int status = writeEntry(it->second);
+    if(status != ZIP_OK && m_error == ZIP_OK)
+      m_error = status;
+  }
+}
+
+int ArchiveWriter::writeEntry(Entry &entry) noexcept
+{
+  const int status = zipOpenNewFileInZip2_64(m_zip,
+    entry.path.join(false).c_str(), nullptr, nullptr, 0, nullptr, 0, nullptr,
+    entry.level ? Z_DEFLATED : 0, entry.level, true, entry.size >= 0xffffffff);
+
+  if(status != ZIP_OK)
+    return status;
+
+  // the data is already deflated or stored as-is (raw mode)
+  const size_t chunkSize = bufferSize();
+  const string &memory = entry.data.m_memory;
+
+  for(size_t offset = 0; offset < memory.size(); offset += chunkSize) {
+    const size_t len = min(chunkSize, memory.size() - offset);
+    const int error = zipWriteInFileInZip(m_zip,
+      &memory[offset], (unsigned int)len);
+
+    if(error != ZIP_OK)
+      return error;
+  }
+
+  if(entry.data.m_spilled) {
+    FILE *file = entry.data.reopen();
+    if(!file)
+      return ZIP_ERRNO;
+
+    string chunk(chunkSize, 0);
+    while(const size_t len = fread(&chunk[0], 1, chunk.size(), file)) {
+      const int error = zipWriteInFileInZip(m_zip, &chunk[0], (unsigned int)len);
+      if(error != ZIP_OK)
+        return error;
+    }
+
+    if(ferror(file))
+      return ZIP_ERRNO;
+  }
+
+  return zipCloseFileInZipRaw64(m_zip, entry.size, entry.crc);
+}
+
+// Extensions of formats that are already compressed
+static bool isCompressedType(const Path &path)
+{
+  static const char *types[] = {
+    "7z", "aac", "bz2", "flac", "gif", "gz", "jpeg", "jpg", "m4a", "mp3",
+    "mp4", "ogg", "opus", "png", "rar", "webp", "xz", "zip",
+  };
+
+  const string &name = path.basename();
+  const size_t dot = name.rfind('.');
+  if(dot == string::npos)
+    return false;
+
+  string ext = name.substr(dot + 1);
+  for(char &c : ext)
+    c = (char)tolower((unsigned char)c);
+
+  for(const char *type : types) {
+    if(ext == type)
+      return true;
+  }
+
+  return false;
+}
+
+// Shannon entropy in bits per byte. Compressed or encrypted data is close to 8.
+static double entropy(const char *data, const size_t size)
+{
+  size_t counts[256]{};
+  for(size_t i = 0; i < size; ++i)
+    ++counts[(unsigned char)data[i]];
+
+  double bits = 0;
+  for(const size_t count : counts) {
+    if(count) {
+      const double p = (double)count / size;
+      bits -= p * log2(p);
+    }
+  }
+
+  return bits;
+}
+
+// Contents of a zip entry in raw form: deflated at the given level or stored
+// as-is if level is (or is lowered to) 0. Whether the data is worth deflating
+// is decided by probing the first chunk. The input is hashed along the way.
+static int compressStream(istream &stream, int *level,
+  ArchiveWriter::EntryData *output, Hash *hash, unsigned long *crc,
+  uint64_t *size)
+{
+  static const double MAX_ENTROPY = 7.5;
+
+  z_stream zs{};
+  string input(bufferSize(), 0), chunk(bufferSize(), 0);
+  bool first = true;
+  int flush;
+
+  *crc = crc32(0, nullptr, 0);
+  *size = 0;
+
+  do {
+    stream.read(&input[0], input.size());
+
+    if(stream.bad()) {
+      if(*level)
+        deflateEnd(&zs);
+      return Z_ERRNO;
+    }
+
+    const uInt len = (uInt)stream.gcount();
+    hash->addData(input.data(), len);
+    *crc = crc32(*crc, (const Bytef *)input.data(), len);
+    *size += len;
+
+    flush = stream.eof() ? Z_FINISH : Z_NO_FLUSH;
+
+    if(first) {
+      first = false;
+
+      if(*level && entropy(input.data(), len) > MAX_ENTROPY)
+        *level = 0;
+
+      if(*level) {
+        const int status = deflateInit2(&zs, *level, Z_DEFLATED,
+          -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+        if(status != Z_OK)
+          return status;
+      }
+    }
+
+    if(!*level) {
+      if(!output->append(input.data(), len))
+        return Z_ERRNO;
+      continue;
+    }
+
+    zs.next_in = (Bytef *)&input[0];
+    zs.avail_in = len;
+
+    do {
+      zs.next_out = (Bytef *)&chunk[0];
+      zs.avail_out = (uInt)chunk.size();
+      deflate(&zs, flush);
+
+      if(!output->append(chunk.data(), chunk.size() - zs.avail_out)) {
+        deflateEnd(&zs);
+        return Z_ERRNO;
+      }
+    } while(zs.avail_out == 0);
+  } while(flush != Z_FINISH);
+
+  if(*level)
+    deflateEnd(&zs);
+
+  return Z_OK;
+}
+
+FileCompressor::FileCompressor(const Path &target,
+    const ArchiveWriterPtr &writer, const string &baseHash)
+  : m_path(target), m_writer(writer), m_baseHash(baseHash),
+    m_ticket(writer->reserveEntry()), m_done(false), m_unchanged(false)
 {
   setSummary("Compressing %s: " + target.join());
 }
 
+FileCompressor::~FileCompressor()
+{
+  // don't hold back the following entries if this task never ran
+  if(!m_done)
+    m_writer->skipEntry(m_ticket);
+}
+
 bool FileCompressor::run()
 {
+  m_done = true;
+
   ifstream stream;
   if(!FS::open(stream, m_path)) {
+    m_writer->skipEntry(m_ticket);
     setError({
       String::format("Could not open file for export (%s)", FS::lastError()),
       m_path.join()});
     return false;
   }
 
-  const int error = m_writer->addFile(m_path, stream);
+  // the file is read once: its hash is compared against the base archive's
+  // after it has been compressed
+  ArchiveWriter::EntryData data(m_writer->spillPath(m_ticket));
+  Hash hash;
+  unsigned long crc;
+  uint64_t size;
+  int level = isCompressedType(m_path) ? 0 : m_writer->level();
+
+  const int error = compressStream(stream, &level, &data, &hash, &crc, &size);
   stream.close();
 
   if(error) {
+    m_writer->skipEntry(m_ticket);
     setError({String::format("Failed to compress file (%d)", error), m_path.join()});
     return false;
   }
 
+  m_hash = hash.digest();
+
+  if(m_hash == m_baseHash) {
+    m_writer->skipEntry(m_ticket);
+    m_unchanged = true;
+    return true;
+  }
+
+  m_writer->addEntry(m_ticket, m_path, move(data), crc, size, level);
+
   return true;
 }
@@ -21,6 +21,12 @@
 #include "path.hpp"
 #include "thread.hpp"
 
+#include <cstdio>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+class Index;
 class ThreadPool;
 
 typedef void *zipFile;
@@ -35,22 +41,99 @@ public:
   ~ArchiveReader();
   int extractFile(const Path &);
   int extractFile(const Path &, std::ostream &) noexcept;
+  int extractFile(const Path &, FILE *) noexcept;
+
+  // files missing from an incremental archive are read from its base
+  void setBase(const std::shared_ptr<ArchiveReader> &base) { m_base = base; }
 
 private:
-  zipFile m_zip;
+  struct EntryPos {
+    uint64_t directoryOffset;
+    uint64_t index;
+  };
+
+  int extract(const Path &, std::ostream *, FILE *) noexcept;
+  void readDirectory(zipFile);
+  int locateFile(zipFile, const Path &) const noexcept;
+
+  // each thread extracting at the same time gets its own handle
+  zipFile acquireHandle() noexcept;
+  void releaseHandle(zipFile) noexcept;
+
+  Path m_path;
+  WDL_Mutex m_mutex;
+  std::vector<zipFile> m_handles;
+  std::unordered_map<std::string, EntryPos> m_directory;
+  std::shared_ptr<ArchiveReader> m_base;
 };
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
+typedef std::shared_ptr<const Index> IndexPtr;
 
 class ArchiveWriter {
 public:
-  ArchiveWriter(const Path &path);
+  // Raw contents of an entry, kept in memory up to a limit and spilled to a
+  // temporary file past that.
+  class EntryData {
+  public:
+    EntryData(const Path &spillPath = {});
+    EntryData(const EntryData &) = delete;
+    EntryData(EntryData &&);
+    ~EntryData();
+
+    bool append(const char *, size_t);
+    bool spill();
+    size_t memoryUsage() const { return m_memory.size(); }
+
+  private:
+    friend ArchiveWriter;
+    FILE *reopen();
+
+    Path m_spillPath;
+    std::string m_memory;
+    FILE *m_file;
+    bool m_spilled;
+  };
+
+  // level is 0 (store only) to 9
+  ArchiveWriter(const Path &path, int level);
   ~ArchiveWriter();
   int addFile(const Path &fn);
   int addFile(const Path &fn, std::istream &) noexcept;
+  int level() const { return m_level; }
+
+  // Entries deflated in parallel are appended in the order their ticket was
+  // reserved by whichever thread completes the next one. These are safe to
+  // call from any thread.
+  size_t reserveEntry();
+  Path spillPath(size_t ticket) const;
+  void addEntry(size_t ticket, const Path &, EntryData &&,
+    unsigned long crc, uint64_t size, int level) noexcept;
+  void skipEntry(size_t ticket) noexcept;
+  int error() const { return m_error; }
 
 private:
+  struct Entry {
+    Path path;
+    EntryData data;
+    unsigned long crc;
+    uint64_t size;
+    int level;
+    bool skip;
+  };
+
+  void setEntry(size_t ticket, Entry &&) noexcept;
+  int writeEntry(Entry &) noexcept;
+
   zipFile m_zip;
+  Path m_path;
+  int m_level;
+  WDL_Mutex m_mutex;
+  size_t m_nextTicket;
+  size_t m_nextWrite;
+  std::map<size_t, Entry> m_pending;
+  size_t m_pendingMemory;
+  int m_error;
 };
 
 typedef std::shared_ptr<ArchiveWriter> ArchiveWriterPtr;
@@ -60,7 +143,7 @@ public:
   FileExtractor(const Path &target, const ArchiveReaderPtr &);
   const TempPath &path() const { return m_path; }
 
-  bool concurrent() const override { return false; }
+  bool concurrent() const override { return true; }
   bool run() override;
 
 private:
@@ -68,17 +151,41 @@ private:
   ArchiveReaderPtr m_reader;
 };
 
+class IndexExtractor : public ThreadTask {
+public:
+  IndexExtractor(const std::string &remote, const ArchiveReaderPtr &);
+  const IndexPtr &index() const { return m_index; }
+
+  bool concurrent() const override { return true; }
+  bool run() override;
+
+private:
+  std::string m_remote;
+  ArchiveReaderPtr m_reader;
+  IndexPtr m_index;
+};
+
 class FileCompressor : public ThreadTask {
 public:
-  FileCompressor(const Path &target, const ArchiveWriterPtr &);
+  // the file is not written if its hash is the same as baseHash
+  FileCompressor(const Path &target, const ArchiveWriterPtr &,
+    const std::string &baseHash = {});
+  ~FileCompressor();
   const Path &path() const { return m_path; }
+  const std::string &hash() const { return m_hash; }
+  bool unchanged() const { return m_unchanged; }
 
-  bool concurrent() const override { return false; }
+  bool concurrent() const override { return true; }
   bool run() override;
 
 private:
   Path m_path;
   ArchiveWriterPtr m_writer;
+  std::string m_baseHash;
+  std::string m_hash;
+  size_t m_ticket;
+  bool m_done;
+  bool m_unchanged;
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include "index.hpp"
 #include "reapack.hpp"
 #include "remote.hpp"
+#include "string.hpp"
 #include "transaction.hpp"
 
 #include <iomanip>
@@ -31,19 +32,137 @@
 using namespace std;
 
 static const Path ARCHIVE_TOC("toc");
+static const Path ARCHIVE_MANIFEST("manifest");
 
-ExportTask::ExportTask(const string &path, Transaction *tx)
-  : Task(tx), m_path(path)
+ImportTask::ImportTask(const Remote &remote, const vector<string> &packages,
+    const ArchiveReaderPtr &reader, const string &archive, Transaction *tx)
+  : Task(tx), m_remote(remote), m_packages(packages), m_reader(reader),
+    m_archive(archive)
 {
 }
 
+bool ImportTask::start()
+{
+  IndexExtractor *job = new IndexExtractor(m_remote.name(), m_reader);
+
+  job->onFinish([=] {
+    if(job->state() == ThreadTask::Success)
+      ready(job->index());
+  });
+
+  tx()->threadPool()->push(job);
+
+  return true;
+}
+
+void ImportTask::ready(const IndexPtr &index)
+{
+  if(tx()->isCancelled())
+    return;
+
+  m_index = index;
+
+  RemoteList &remotes = g_reapack->config()->remotes;
+  const Remote &original = remotes.get(m_remote.name());
+  if(original.isProtected()) {
+    m_remote.setUrl(original.url());
+    m_remote.protect();
+  }
+
+  remotes.add(m_remote);
+
+  for(const string &data : m_packages) {
+    try {
+      importPackage(data);
+    }
+    catch(const reapack_error &e) {
+      tx()->receipt()->addError({e.what(), m_archive});
+    }
+  }
+
+  // don't wait for the other indexes before installing this remote's packages
+  tx()->startQueued();
+}
+
+void ImportTask::importPackage(const string &data)
+{
+  string categoryName, packageName, versionName;
+  bool pinned;
+
+  istringstream stream(data);
+  stream
+    >> quoted(categoryName) >> quoted(packageName) >> quoted(versionName)
+    >> pinned;
+
+  const Package *pkg = m_index->find(categoryName, packageName);
+  const Version *ver = pkg ? pkg->findVersion(versionName) : nullptr;
+
+  if(!ver) {
+    throw reapack_error(String::format(
+      "%s/%s/%s v%s cannot be found or is incompatible with your operating system.",
+      m_index->name().c_str(), categoryName.c_str(),
+      packageName.c_str(), versionName.c_str()));
+  }
+
+  tx()->install(ver, pinned, m_reader);
+}
+
+void ImportTask::commit()
+{
+  if(m_index)
+    g_reapack->config()->write();
+}
+
+ExportTask::ExportTask(const string &path, const string &base, Transaction *tx)
+  : Task(tx), m_path(path), m_base(base)
+{
+}
+
+bool ExportTask::readBaseManifest(Manifest *manifest)
+{
+  const Path base(m_base);
+  stringstream stream;
+
+  try {
+    // imports look for the base archive next to the incremental one
+    if(base.dirname() != m_path.target().dirname())
+      throw reapack_error("it must be in the same directory as the new archive");
+
+    ArchiveReader reader(base);
+    if(const int err = reader.extractFile(ARCHIVE_MANIFEST, stream))
+      throw reapack_error(String::format("Cannot locate the manifest (%d)", err));
+  }
+  catch(const reapack_error &e) {
+    tx()->receipt()->addError({string("Could not use the base archive: ") +
+      e.what(), m_base});
+    return false;
+  }
+
+  string line;
+  while(getline(stream, line)) {
+    const size_t space = line.find('\x20');
+    if(space != string::npos)
+      (*manifest)[line.substr(space + 1)] = line.substr(0, space);
+  }
+
+  return true;
+}
+
 bool ExportTask::start()
 {
   stringstream toc;
-  ArchiveWriterPtr writer;
+  Manifest baseManifest;
+
+  if(!m_base.empty()) {
+    if(!readBaseManifest(&baseManifest))
+      return false;
+
+    toc << "BASE " << quoted(Path(m_base).basename()) << '\n';
+  }
 
   try {
-    writer = make_shared<ArchiveWriter>(m_path.temp());
+    m_writer = make_shared<ArchiveWriter>(m_path.temp(),
+      (int)g_reapack->config()->archive.compressionLevel);
   }
   catch(const reapack_error &e) {
     tx()->receipt()->addError({string("Could not open archive for writing: ") +
@@ -53,13 +172,28 @@ bool ExportTask::start()
 
   vector<FileCompressor *> jobs;
 
+  const auto addJob = [&](const Path &path, const Registry::File *state) {
+    const auto it = baseManifest.find(path.join(false));
+    const string &baseHash = it == baseManifest.end() ? string() : it->second;
+
+    // left untouched since it was installed with the same contents as in the
+    // base archive: no need to read it
+    if(state && !baseHash.empty() && state->hash == baseHash &&
+        state->isUnchanged()) {
+      m_manifest[path.join(false)] = baseHash;
+      return;
+    }
+
+    jobs.push_back(new FileCompressor(path, m_writer, baseHash));
+  };
+
   for(const Remote &remote : g_reapack->config()->remotes.getEnabled()) {
     bool addedRemote = false;
 
     for(const Registry::Entry &entry : tx()->registry()->getEntries(remote.name())) {
       if(!addedRemote) {
         toc << "REPO " << remote.toString() << '\n';
-        jobs.push_back(new FileCompressor(Index::pathFor(remote.name()), writer));
+        addJob(Index::pathFor(remote.name()), nullptr);
         addedRemote = true;
       }
 
@@ -71,19 +205,23 @@ bool ExportTask::start()
       ;
 
       for(const Registry::File &file : tx()->registry()->getFiles(entry))
-        jobs.push_back(new FileCompressor(file.path, writer));
+        addJob(file.path, &file);
     }
   }
 
-  writer->addFile(ARCHIVE_TOC, toc);
+  m_writer->addFile(ARCHIVE_TOC, toc);
 
-  // Start after we've written the table of contents in the main thread
-  // because we cannot safely write into the zip from more than one
-  // thread at the same time.
+  // Files are compressed concurrently by all workers, then appended to the
+  // archive after the table of contents in the order they were queued.
   for(FileCompressor *job : jobs) {
     job->onFinish([=] {
-    if(job->state() == ThreadTask::Success)
-      tx()->receipt()->addExport(job->path());
+      if(job->state() != ThreadTask::Success)
+        return;
+
+      m_manifest[job->path().join(false)] = job->hash();
+
+      if(!job->unchanged())
+        tx()->receipt()->addExport(job->path());
     });
 
     tx()->threadPool()->push(job);
@@ -94,6 +232,25 @@ bool ExportTask::start()
 
 void ExportTask::commit()
 {
+  // the manifest lists every file, including those left in the base archive
+  stringstream manifest;
+  for(const auto &pair : m_manifest)
+    manifest << pair.second << '\x20' << pair.first << '\n';
+
+  int error = m_writer->error();
+  if(!error)
+    error = m_writer->addFile(ARCHIVE_MANIFEST, manifest);
+
+  m_writer.reset(); // close the archive before moving it
+
+  if(error) {
+    tx()->receipt()->addError({
+      String::format("Could not write archive (%d)", error),
+      m_path.temp().join()});
+    FS::remove(m_path.temp());
+    return;
+  }
+
   if(!FS::rename(m_path)) {
     tx()->receipt()->addError({string("Could not move to permanent location: ") +
       FS::lastError(), m_path.target().prependRoot().join()});
@@ -102,5 +259,6 @@ void ExportTask::commit()
 
 void ExportTask::rollback()
 {
+  m_writer.reset();
   FS::remove(m_path.temp());
 }
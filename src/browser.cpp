@@ -19,6 +19,7 @@
 
 #include "about.hpp"
 #include "browser_entry.hpp"
+#include "browser_loader.hpp"
 #include "config.hpp"
 #include "errors.hpp"
 #include "index.hpp"
@@ -33,11 +34,26 @@ using namespace std;
 
 enum Timers { TIMER_FILTER = 1, TIMER_ABOUT };
 
+// Rows store the index of their entry in m_entries (also its document in the
+// search index) rather than a pointer, which would not survive a reallocation.
+static size_t entryIndex(const ListView::Row *row)
+{
+  return reinterpret_cast<size_t>(row->userData);
+}
+
 Browser::Browser()
-  : Dialog(IDD_BROWSER_DIALOG), m_loadState(Init), m_currentIndex(-1)
+  : Dialog(IDD_BROWSER_DIALOG), m_loadState(Init), m_loader(nullptr),
+    m_currentIndex(-1), m_actionsGeneration(0)
 {
 }
 
+Browser::~Browser()
+{
+  // the loader deletes itself once its thread is done
+  if(m_loader)
+    m_loader->cancel();
+}
+
 void Browser::onInit()
 {
   m_applyBtn = getControl(IDAPPLY);
@@ -56,8 +72,10 @@ void Browser::onInit()
   SendMessage(m_view, CB_ADDSTRING, 0, (LPARAM)L("Out of date"));
   SendMessage(m_view, CB_ADDSTRING, 0, (LPARAM)L("Obsolete"));
   SendMessage(m_view, CB_ADDSTRING, 0, (LPARAM)L("Uninstalled"));
+  SendMessage(m_view, CB_ADDSTRING, 0, (LPARAM)L("Changed"));
   SendMessage(m_view, CB_SETCURSEL, 0, 0);
 
+  // don't forget to update order of enum Column in header file
   m_list = createControl<ListView>(IDC_LIST, ListView::Columns{
     {"Status",       23, ListView::NoLabelFlag},
     {"Package",     345, ListView::FilterFlag},
@@ -72,7 +90,12 @@ void Browser::onInit()
   m_list->onActivate([=] { aboutPackage(m_list->itemUnderMouse()); });
   m_list->onSelect(bind(&Browser::onSelection, this));
   m_list->onContextMenu(bind(&Browser::fillContextMenu, this, _1, _2));
-  m_list->sortByColumn(1);
+  m_list->setCellHandler([=] (const ListView::Row *row, const int column,
+      ListView::Cell *cell) {
+    m_entries[entryIndex(row)].fillCell(column, cell);
+  });
+  m_list->setFilterIndex(&m_searchIndex, entryIndex);
+  m_list->sortByColumn(NameColumn);
 
   Dialog::onInit();
   setMinimumSize({600, 250});
@@ -466,98 +489,146 @@ void Browser::refresh(const bool stale)
 
 void Browser::populate(const vector<IndexPtr> &indexes, const Registry *reg)
 {
+  if(m_loader)
+    m_loader->cancel();
+
+  Loader *loader = m_loader = new Loader(this, indexes, reg);
+
+  loader->onFinish([loader] {
+    if(Browser *browser = loader->browser())
+      browser->finishLoading(loader);
+  });
+
+  loader->start();
+}
+
+void Browser::finishLoading(Loader *loader)
+{
+  m_loader = nullptr;
+
+  if(loader->state() != ThreadTask::Success)
+    return;
+
   // keep previous entries in memory a bit longer for #transferActions
+  // and to restore the selection in #fillList
   vector<Entry> oldEntries;
   swap(m_entries, oldEntries);
 
+  list<Entry *> actions;
+  loader->swapEntries(&m_entries, &m_searchIndex, &actions);
+  m_indexes = loader->indexes();
+
   m_currentIndex = -1;
 
-  for(const IndexPtr &index : indexes) {
-    for(const Package *pkg : index->packages())
-      m_entries.push_back({pkg, reg->getEntry(pkg), index});
+  // the queued actions were transferred by the loader unless they were
+  // modified after it was started
+  if(loader->actionsGeneration() == m_actionsGeneration) {
+    swap(m_actions, actions);
 
-    // obsolete packages
-    for(const Registry::Entry &regEntry : reg->getEntries(index->name())) {
-      if(!index->find(regEntry.category, regEntry.package))
-        m_entries.push_back({regEntry, index});
-    }
+    if(m_actions.empty())
+      disable(m_applyBtn);
   }
+  else
+    transferActions();
 
-  transferActions();
-  fillList();
+  if(!updateList(oldEntries))
+    fillList(&oldEntries);
 
   if(!isVisible())
     show();
 }
 
-void Browser::setFilter(const string &newFilter)
-{
-  Win32::setWindowText(m_filter, newFilter.c_str());
-  updateFilter(); // don't wait for the timer, update now!
-  SetFocus(m_filter);
-}
-
 void Browser::transferActions()
 {
   list<Entry *> oldActions;
   swap(m_actions, oldActions);
 
+  Entry::Lookup lookup;
+  if(!oldActions.empty()) {
+    lookup.reserve(m_entries.size());
+    for(size_t i = 0; i < m_entries.size(); ++i)
+      lookup.emplace(&m_entries[i], i);
+  }
+
   for(Entry *oldEntry : oldActions) {
-    const auto &entryIt = find(m_entries.begin(), m_entries.end(), *oldEntry);
-    if(entryIt == m_entries.end())
+    const auto &it = lookup.find(oldEntry);
+    if(it == lookup.end())
       continue;
 
-    if(oldEntry->target) {
-      const Version *target = *oldEntry->target;
+    Entry *entry = &m_entries[it->second];
+    if(entry->transferAction(*oldEntry))
+      m_actions.push_back(entry);
+  }
+
+  ++m_actionsGeneration;
 
-      if(target) {
-        const Package *pkg = entryIt->package;
-        if(!pkg || !(target = pkg->findVersion(target->name())))
-          continue;
-      }
+  if(m_actions.empty())
+    disable(m_applyBtn);
+}
 
-      entryIt->target = target;
-    }
+bool Browser::updateList(const vector<Entry> &oldEntries)
+{
+  // The existing rows are kept if the same packages are listed in the same
+  // order. Only the rows of the entries that changed are updated.
+  if(oldEntries.size() != m_entries.size())
+    return false;
+
+  for(size_t i = 0; i < m_entries.size(); ++i) {
+    if(!(oldEntries[i] == m_entries[i]) ||
+        match(oldEntries[i]) != match(m_entries[i]))
+      return false;
+  }
+
+  ListView::BeginEdit edit(m_list);
 
-    if(oldEntry->pin)
-      entryIt->pin = *oldEntry->pin;
+  for(int i = 0; i < m_list->rowCount(); ++i) {
+    const size_t index = entryIndex(m_list->row(i).get());
+    const Entry &oldEntry = oldEntries[index], &entry = m_entries[index];
 
-    m_actions.push_back(&*entryIt);
+    if(entry.test(Entry::ChangedFlag) ||
+        entry.displayState() != oldEntry.displayState() ||
+        entry.displayVersion() != oldEntry.displayVersion())
+      m_list->updateRow(i);
   }
 
-  if(m_actions.empty())
-    disable(m_applyBtn);
+  m_list->endEdit();
+  updateDisplayLabel();
+
+  return true;
 }
 
-void Browser::fillList()
+void Browser::fillList(const vector<Entry> *previous)
 {
   ListView::BeginEdit edit(m_list);
 
   const int scroll = m_list->scroll();
 
+  if(!previous)
+    previous = &m_entries;
+
   vector<int> selectIndexes = m_list->selection();
-  vector<const Entry *> oldSelection(selectIndexes.size());
-  for(size_t i = 0; i < selectIndexes.size(); i++)
-    oldSelection[i] = static_cast<Entry *>(m_list->row(selectIndexes[i])->userData);
+  Entry::Set oldSelection(selectIndexes.size());
+  for(const int index : selectIndexes)
+    oldSelection.insert(&(*previous)[entryIndex(m_list->row(index).get())]);
   selectIndexes.clear(); // will put new indexes below
 
   m_list->clear();
   m_list->reserveRows(m_entries.size());
 
-  for(const Entry &entry : m_entries) {
+  for(size_t i = 0; i < m_entries.size(); ++i) {
+    const Entry &entry = m_entries[i];
+
     if(!match(entry))
       continue;
 
-    auto row = m_list->createRow((void *)&entry);
-    entry.updateRow(row);
-
-    const auto &matchingEntryIt = find_if(oldSelection.begin(), oldSelection.end(),
-      [&entry] (const Entry *oldEntry) { return *oldEntry == entry; });
+    auto row = m_list->createRow(reinterpret_cast<void *>(i));
 
-    if(matchingEntryIt != oldSelection.end())
+    if(!oldSelection.empty() && oldSelection.count(&entry))
       selectIndexes.push_back(row->index());
   }
 
+  m_list->endEdit(); // filter and sort before restoring the selection
+
   m_list->setScroll(scroll);
 
   // restore selection only after having sorted the table
@@ -565,7 +636,6 @@ void Browser::fillList()
   for(const int index : selectIndexes)
     m_list->select(index);
 
-  m_list->endEdit(); // filter before calling updateDisplayLabel
   updateDisplayLabel();
 }
 
@@ -597,6 +667,10 @@ bool Browser::match(const Entry &entry) const
     if(!entry.test(Entry::ObsoleteFlag))
       return false;
     break;
+  case ChangedView:
+    if(!entry.test(Entry::ChangedFlag))
+      return false;
+    break;
   }
 
   return true;
@@ -607,7 +681,7 @@ auto Browser::getEntry(const int index) -> Entry *
   if(index < 0)
     return nullptr;
   else
-    return static_cast<Entry *>(m_list->row(index)->userData);
+    return &m_entries[entryIndex(m_list->row(index).get())];
 }
 
 void Browser::aboutPackage(const int index, const bool focus)
@@ -756,6 +830,8 @@ void Browser::updateAction(const int index)
   if(!entry)
     return;
 
+  ++m_actionsGeneration;
+
   const auto &it = find(m_actions.begin(), m_actions.end(), entry);
   if(!entry->target && (!entry->pin || !entry->test(Entry::CanTogglePin))) {
     if(it != m_actions.end())
@@ -767,7 +843,7 @@ void Browser::updateAction(const int index)
   if(currentView() == QueuedView && !hasAction(entry))
     m_list->removeRow(index);
   else
-    m_list->row(index)->setCell(0, entry->displayState());
+    m_list->row(index)->setCell(StateColumn, entry->displayState());
 }
 
 void Browser::listDo(const function<void (int)> &func, const vector<int> &indexes)
@@ -868,6 +944,7 @@ bool Browser::apply()
   }
 
   m_actions.clear();
+  ++m_actionsGeneration;
   disable(m_applyBtn);
 
   if(!tx->runTasks()) {
@@ -881,7 +958,7 @@ bool Browser::apply()
       m_list->clear();
     else {
       for(int i = 0, count = m_list->rowCount(); i < count; ++i)
-        m_list->row(i)->setCell(0, getEntry(i)->displayState());
+        m_list->row(i)->setCell(StateColumn, getEntry(i)->displayState());
     }
   }
 
@@ -21,6 +21,7 @@
 #include "dialog.hpp"
 
 #include "package.hpp"
+#include "trigram.hpp"
 
 #include <boost/optional.hpp>
 #include <functional>
@@ -58,6 +59,7 @@ public:
   };
 
   Browser();
+  ~Browser();
   void refresh(bool stale = false);
   void setFilter(const std::string &);
 
@@ -70,6 +72,7 @@ protected:
 
 private:
   class Entry; // browser_entry.hpp
+  class Loader; // browser_loader.hpp
 
   enum View {
     AllView,
@@ -78,6 +81,18 @@ private:
     OutOfDateView,
     ObsoleteView,
     UninstalledView,
+    ChangedView,
+  };
+
+  enum Column {
+    StateColumn,
+    NameColumn,
+    CategoryColumn,
+    VersionColumn,
+    AuthorColumn,
+    TypeColumn,
+    RemoteColumn,
+    TimeColumn,
   };
 
   enum LoadState {
@@ -90,11 +105,14 @@ private:
   void onSelection();
   bool fillContextMenu(Menu &, int index);
   void populate(const std::vector<IndexPtr> &, const Registry *);
+  void finishLoading(Loader *);
   void transferActions();
   bool match(const Entry &) const;
   void updateFilter();
   void updateAbout();
-  void fillList();
+  // previous: the entries of the current rows if they were just replaced
+  void fillList(const std::vector<Entry> *previous = nullptr);
+  bool updateList(const std::vector<Entry> &oldEntries);
   Entry *getEntry(int listIndex);
   void updateDisplayLabel();
   void displayButton();
@@ -131,11 +149,15 @@ private:
   void aboutPackage(int index, bool focus = true);
 
   LoadState m_loadState;
+  Loader *m_loader;
   int m_currentIndex;
 
   boost::optional<Package::Type> m_typeFilter;
+  std::vector<IndexPtr> m_indexes;
   std::vector<Entry> m_entries;
   std::list<Entry *> m_actions;
+  size_t m_actionsGeneration; // incremented when m_actions changes
+  TrigramIndex m_searchIndex;
 
   HWND m_filter;
   HWND m_view;
@@ -20,17 +20,18 @@
 #include "config.hpp"
 #include "index.hpp"
 #include "menu.hpp"
-#include "reapack.hpp"
 #include "string.hpp"
+#include "trigram.hpp"
 
+#include <boost/functional/hash.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 
 using namespace std;
 
-Browser::Entry::Entry(const Package *pkg, const Registry::Entry &re, const IndexPtr &i)
+Browser::Entry::Entry(const Package *pkg, const Registry::Entry &re,
+    const IndexPtr &i, const InstallOpts &instOpts, const bool isProtected)
   : m_flags(0), regEntry(re), package(pkg), index(i), current(nullptr)
 {
-  const auto &instOpts = g_reapack->config()->install;
   latest = pkg->lastVersion(instOpts.bleedingEdge, regEntry.version);
 
   if(regEntry) {
@@ -49,7 +50,7 @@ Browser::Entry::Entry(const Package *pkg, const Registry::Entry &re, const Index
   if(!latest)
     latest = pkg->lastVersion(true);
 
-  if(g_reapack->remote(indexName()).isProtected())
+  if(isProtected)
     m_flags |= ProtectedFlag;
 }
 
@@ -150,19 +151,48 @@ const Time *Browser::Entry::lastUpdate() const
   return latest ? &latest->time() : nullptr;
 }
 
-void Browser::Entry::updateRow(const ListView::RowPtr &row) const
+void Browser::Entry::fillCell(const int column, ListView::Cell *cell) const
 {
-  int c = 0;
-  const Time *time = lastUpdate();
-
-  row->setCell(c++, displayState());
-  row->setCell(c++, displayName());
-  row->setCell(c++, categoryName());
-  row->setCell(c++, displayVersion(), (void *)sortVersion());
-  row->setCell(c++, displayAuthor());
-  row->setCell(c++, displayType());
-  row->setCell(c++, indexName());
-  row->setCell(c++, time ? time->toString() : string(), (void *)time);
+  switch(column) {
+  case StateColumn:
+    cell->value = displayState();
+    break;
+  case NameColumn:
+    cell->value = displayName();
+    break;
+  case CategoryColumn:
+    cell->value = categoryName();
+    break;
+  case VersionColumn:
+    cell->value = displayVersion();
+    cell->userData = (void *)sortVersion();
+    break;
+  case AuthorColumn:
+    cell->value = displayAuthor();
+    break;
+  case TypeColumn:
+    cell->value = displayType();
+    break;
+  case RemoteColumn:
+    cell->value = indexName();
+    break;
+  case TimeColumn:
+    if(const Time *time = lastUpdate()) {
+      cell->value = time->toString();
+      cell->userData = (void *)time;
+    }
+    break;
+  }
+}
+
+void Browser::Entry::addSearchTerms(const size_t doc, TrigramIndex *index) const
+{
+  // Must cover every column having ListView::FilterFlag in the browser.
+  // The display name already is either the package's name or its description.
+  index->add(doc, displayName());
+  index->add(doc, categoryName());
+  index->add(doc, displayAuthor());
+  index->add(doc, indexName());
 }
 
 void Browser::Entry::fillMenu(Menu &menu) const
@@ -253,6 +283,35 @@ int Browser::Entry::possibleActions(bool allowToggle) const
   return flags;
 }
 
+bool Browser::Entry::transferAction(const Entry &old)
+{
+  if(old.target) {
+    const Version *newTarget = *old.target;
+
+    if(newTarget) {
+      if(!package || !(newTarget = package->findVersion(newTarget->name())))
+        return false;
+    }
+
+    target = newTarget;
+  }
+
+  if(old.pin)
+    pin = *old.pin;
+
+  return true;
+}
+
+size_t Browser::Entry::Hash::operator()(const Entry *entry) const
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, entry->indexName());
+  boost::hash_combine(seed, entry->categoryName());
+  boost::hash_combine(seed, entry->packageName());
+
+  return seed;
+}
+
 bool Browser::Entry::operator==(const Entry &o) const
 {
   return indexName() == o.indexName() && categoryName() == o.categoryName() &&
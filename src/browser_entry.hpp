@@ -24,10 +24,14 @@
 
 #include <boost/optional.hpp>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 
 class Index;
+struct InstallOpts;
 class Menu;
 class Remote;
+class TrigramIndex;
 
 typedef std::shared_ptr<const Index> IndexPtr;
 
@@ -39,6 +43,7 @@ public:
     OutOfDateFlag   = 1<<2,
     ObsoleteFlag    = 1<<3,
     ProtectedFlag   = 1<<4,
+    ChangedFlag     = 1<<5, // since the previous refresh
   };
 
   enum PossibleAction {
@@ -50,7 +55,17 @@ public:
     CanTogglePin     = 1<<10,
   };
 
-  Entry(const Package *, const Registry::Entry &, const IndexPtr &);
+  // hash and compare entries by identity (remote, category and package)
+  struct Hash { size_t operator()(const Entry *) const; };
+  struct Equal {
+    bool operator()(const Entry *l, const Entry *r) const { return *l == *r; }
+  };
+
+  typedef std::unordered_set<const Entry *, Hash, Equal> Set;
+  typedef std::unordered_map<const Entry *, size_t, Hash, Equal> Lookup;
+
+  Entry(const Package *, const Registry::Entry &, const IndexPtr &,
+    const InstallOpts &, bool isProtected);
   Entry(const Registry::Entry &, const IndexPtr &);
 
   boost::optional<const Version *> target;
@@ -68,8 +83,11 @@ public:
   std::string displayAuthor() const;
   const Time *lastUpdate() const;
 
-  void updateRow(const ListView::RowPtr &) const;
+  void fillCell(int column, ListView::Cell *) const;
+  void addSearchTerms(size_t document, TrigramIndex *) const;
   void fillMenu(Menu &) const;
+  bool transferAction(const Entry &);
+  void markChanged() { m_flags |= ChangedFlag; }
 
   int possibleActions(bool allowToggle) const;
   bool test(Flag f) const { return (m_flags & f) == f; }
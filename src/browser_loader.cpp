@@ -0,0 +1,139 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "browser_loader.hpp"
+
+#include "index.hpp"
+#include "index_diff.hpp"
+#include "reapack.hpp"
+#include "remote.hpp"
+
+#include <map>
+
+using namespace std;
+
+Browser::Loader::Loader(Browser *browser, const vector<IndexPtr> &indexes,
+    const Registry *reg)
+  : m_browser(browser), m_indexes(indexes),
+    m_previousIndexes(browser->m_indexes),
+    m_opts(g_reapack->config()->install),
+    m_actionsGeneration(browser->m_actionsGeneration)
+{
+  setSummary("Loading the package list...");
+
+  m_regEntries.reserve(m_indexes.size());
+  m_protected.reserve(m_indexes.size());
+
+  for(const IndexPtr &index : m_indexes) {
+    m_regEntries.push_back(reg->getEntries(index->name()));
+    m_protected.push_back(g_reapack->remote(index->name()).isProtected());
+  }
+
+  for(const Entry *entry : browser->m_actions)
+    m_oldActions.push_back(*entry);
+}
+
+void Browser::Loader::cancel()
+{
+  abort();
+  m_browser = nullptr;
+}
+
+bool Browser::Loader::run()
+{
+  typedef pair<string, string> Key; // category, package
+
+  for(size_t i = 0; i < m_indexes.size(); ++i) {
+    if(aborted())
+      return false;
+
+    const IndexPtr &index = m_indexes[i];
+
+    // flag what changed since the previous refresh (if any)
+    const Index *previous = nullptr;
+    unique_ptr<IndexDiff> diff;
+    if(!m_previousIndexes.empty()) {
+      for(const IndexPtr &prevIndex : m_previousIndexes) {
+        if(prevIndex->name() == index->name())
+          previous = prevIndex.get();
+      }
+
+      diff = make_unique<IndexDiff>(previous, index.get());
+    }
+
+    map<Key, const Registry::Entry *> installed;
+    for(const Registry::Entry &regEntry : m_regEntries[i])
+      installed[{regEntry.category, regEntry.package}] = &regEntry;
+
+    for(const Package *pkg : index->packages()) {
+      const auto &it = installed.find({pkg->category()->name(), pkg->name()});
+      const Registry::Entry &regEntry =
+        it == installed.end() ? Registry::Entry{} : *it->second;
+
+      m_entries.push_back({pkg, regEntry, index, m_opts, m_protected[i]});
+
+      if(diff && diff->changed(pkg))
+        m_entries.back().markChanged();
+    }
+
+    // obsolete packages
+    for(const Registry::Entry &regEntry : m_regEntries[i]) {
+      if(index->find(regEntry.category, regEntry.package))
+        continue;
+
+      m_entries.push_back({regEntry, index});
+
+      if(previous && previous->find(regEntry.category, regEntry.package))
+        m_entries.back().markChanged();
+    }
+  }
+
+  for(size_t i = 0; i < m_entries.size(); ++i)
+    m_entries[i].addSearchTerms(i, &m_searchIndex);
+
+  transferActions();
+
+  return !aborted();
+}
+
+void Browser::Loader::transferActions()
+{
+  if(m_oldActions.empty())
+    return;
+
+  Entry::Lookup lookup(m_entries.size());
+  for(size_t i = 0; i < m_entries.size(); ++i)
+    lookup.emplace(&m_entries[i], i);
+
+  for(const Entry &oldEntry : m_oldActions) {
+    const auto &it = lookup.find(&oldEntry);
+    if(it == lookup.end())
+      continue;
+
+    Entry *entry = &m_entries[it->second];
+    if(entry->transferAction(oldEntry))
+      m_actions.push_back(entry);
+  }
+}
+
+void Browser::Loader::swapEntries(vector<Entry> *entries,
+  TrigramIndex *searchIndex, list<Entry *> *actions)
+{
+  swap(*entries, m_entries);
+  swap(*searchIndex, m_searchIndex);
+  swap(*actions, m_actions);
+}
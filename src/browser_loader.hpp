@@ -0,0 +1,64 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_BROWSER_LOADER_HPP
+#define REAPACK_BROWSER_LOADER_HPP
+
+#include "browser.hpp"
+#include "browser_entry.hpp"
+#include "config.hpp"
+#include "thread.hpp"
+
+#include <list>
+#include <vector>
+
+// Builds the browser's entries in a worker thread. Everything needed from the
+// registry and the configuration is copied in the constructor (main thread).
+class Browser::Loader : public ThreadTask {
+public:
+  Loader(Browser *, const std::vector<IndexPtr> &, const Registry *);
+
+  bool concurrent() const override { return true; }
+
+  Browser *browser() const { return m_browser; }
+  const std::vector<IndexPtr> &indexes() const { return m_indexes; }
+  void cancel();
+
+  size_t actionsGeneration() const { return m_actionsGeneration; }
+  void swapEntries(std::vector<Entry> *, TrigramIndex *, std::list<Entry *> *);
+
+protected:
+  bool run() override;
+
+private:
+  void transferActions();
+
+  Browser *m_browser;
+  std::vector<IndexPtr> m_indexes;
+  std::vector<IndexPtr> m_previousIndexes;
+  std::vector<std::vector<Registry::Entry>> m_regEntries;
+  std::vector<bool> m_protected;
+  InstallOpts m_opts;
+  std::vector<Entry> m_oldActions;
+  size_t m_actionsGeneration;
+
+  std::vector<Entry> m_entries;
+  TrigramIndex m_searchIndex;
+  std::list<Entry *> m_actions;
+};
+
+#endif
@@ -46,6 +46,13 @@ static const char *NETWORK_GRP = "network";
 static const char *PROXY_KEY = "proxy";
 static const char *VERIFYPEER_KEY = "verifypeer";
 static const char *STALETHRSH_KEY = "stalethreshold";
+static const char *DLORDER_KEY = "downloadorder";
+static const char *HOSTCONNS_KEY = "hostconnections";
+static const char *MAXSPEED_KEY = "maxspeed";
+static const char *BUFFERSIZE_KEY = "buffersize";
+
+static const char *ARCHIVE_GRP = "archive";
+static const char *COMPRESSION_KEY = "compression";
 
 static const char *SIZE_KEY = "size";
 
@@ -66,7 +73,9 @@ Config::Config()
 void Config::resetOptions()
 {
   install = {false, false, true};
-  network = {"", true, NetworkOpts::OneWeekThreshold};
+  network = {"", true, NetworkOpts::OneWeekThreshold,
+    NetworkOpts::LargestFirst, 0, 0, 256};
+  archive = {6, 256};
   windowState = {};
 }
 
@@ -142,6 +151,30 @@ void Config::read(const Path &path)
   network.verifyPeer = getBool(NETWORK_GRP, VERIFYPEER_KEY, network.verifyPeer);
   network.staleThreshold = (time_t)getUInt(NETWORK_GRP,
     STALETHRSH_KEY, (unsigned int)network.staleThreshold);
+  network.downloadOrder = (NetworkOpts::DownloadOrder)getUInt(NETWORK_GRP,
+    DLORDER_KEY, network.downloadOrder);
+  network.hostConnections = getUInt(NETWORK_GRP,
+    HOSTCONNS_KEY, network.hostConnections);
+  network.maxSpeed = getUInt(NETWORK_GRP, MAXSPEED_KEY, network.maxSpeed);
+  network.bufferSize = getUInt(NETWORK_GRP,
+    BUFFERSIZE_KEY, network.bufferSize);
+  // curl ignores sizes outside of 1 KiB to CURL_MAX_READ_SIZE (512 KiB)
+  if(network.bufferSize < 1)
+    network.bufferSize = 1;
+  else if(network.bufferSize > 512)
+    network.bufferSize = 512;
+
+  archive.compressionLevel = getUInt(ARCHIVE_GRP,
+    COMPRESSION_KEY, archive.compressionLevel);
+  if(archive.compressionLevel > 9)
+    archive.compressionLevel = 9;
+  archive.bufferSize = getUInt(ARCHIVE_GRP,
+    BUFFERSIZE_KEY, archive.bufferSize);
+  // allocated by every compression and extraction worker
+  if(archive.bufferSize < 4)
+    archive.bufferSize = 4;
+  else if(archive.bufferSize > 16 * 1024)
+    archive.bufferSize = 16 * 1024;
 
   windowState.about = getString(ABOUT_GRP, STATE_KEY, windowState.about);
   windowState.browser = getString(BROWSER_GRP, STATE_KEY, windowState.browser);
@@ -163,6 +196,13 @@ void Config::write()
   setString(NETWORK_GRP, PROXY_KEY, network.proxy);
   setUInt(NETWORK_GRP, VERIFYPEER_KEY, network.verifyPeer);
   setUInt(NETWORK_GRP, STALETHRSH_KEY, (unsigned int)network.staleThreshold);
+  setUInt(NETWORK_GRP, DLORDER_KEY, network.downloadOrder);
+  setUInt(NETWORK_GRP, HOSTCONNS_KEY, network.hostConnections);
+  setUInt(NETWORK_GRP, MAXSPEED_KEY, network.maxSpeed);
+  setUInt(NETWORK_GRP, BUFFERSIZE_KEY, network.bufferSize);
+
+  setUInt(ARCHIVE_GRP, COMPRESSION_KEY, archive.compressionLevel);
+  setUInt(ARCHIVE_GRP, BUFFERSIZE_KEY, archive.bufferSize);
 
   setString(ABOUT_GRP, STATE_KEY, windowState.about);
   setString(BROWSER_GRP, STATE_KEY, windowState.browser);
@@ -42,9 +42,24 @@ struct NetworkOpts {
     OneWeekThreshold = 7 * 24 * 3600,
   };
 
+  enum DownloadOrder {
+    QueueOrder,
+    LargestFirst,  // shortest total time
+    SmallestFirst, // most packages completed early
+  };
+
   std::string proxy;
   bool verifyPeer;
   time_t staleThreshold;
+  DownloadOrder downloadOrder;
+  unsigned int hostConnections; // 0 = unlimited
+  unsigned int maxSpeed; // KiB/s shared by all downloads, 0 = unlimited
+  unsigned int bufferSize; // KiB, 1 to 512
+};
+
+struct ArchiveOpts {
+  unsigned int compressionLevel; // 0 = store only, 1 (fastest) to 9 (smallest)
+  unsigned int bufferSize; // KiB, 4 to 16384
 };
 
 class Config {
@@ -61,6 +76,7 @@ public:
 
   InstallOpts install;
   NetworkOpts network;
+  ArchiveOpts archive;
   WindowState windowState;
 
   RemoteList remotes;
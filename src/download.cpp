@@ -19,18 +19,35 @@
 
 #include "filesystem.hpp"
 #include "reapack.hpp"
+#include "trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 #include <reaper_plugin_functions.h>
 
 using namespace std;
 
 static const int DOWNLOAD_TIMEOUT = 15;
+// Content-Length is only a hint from the server, larger values are ignored
+static const int64_t MAX_MEMORY_RESERVE = 8 * 1024 * 1024;
+static const int64_t MAX_FILE_RESERVE = 1024 * 1024 * 1024;
 // to set the amount of concurrent downloads, change the size of
 // the m_pool member in ThreadPool (thread.hpp)
 
 static CURLSH *g_curlShare = nullptr;
 static WDL_Mutex g_curlMutex;
 
+// token bucket shared by every download when NetworkOpts::maxSpeed is set
+static WDL_Mutex g_bucketMutex;
+static double g_bucketTokens = 0;
+static chrono::steady_clock::time_point g_bucketTime;
+
+static atomic<int> g_foregroundDownloads(0);
+static atomic<int64_t> g_received(0);
+static const auto BACKGROUND_DELAY = chrono::milliseconds(50);
+
 static void LockCurlMutex(CURL *, curl_lock_data, curl_lock_access, void *)
 {
   g_curlMutex.Enter();
@@ -53,6 +70,11 @@ void DownloadContext::GlobalInit()
 
   curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
   curl_share_setopt(g_curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+  // The connection cache is not shared: libcurl does not support using it
+  // from several threads at once, and each worker runs its own easy handle.
+  // Reusing connections across downloads (and HTTP/2 multiplexing) would
+  // require driving every transfer from a single curl_multi handle.
 }
 
 void DownloadContext::GlobalCleanup()
@@ -79,6 +101,9 @@ DownloadContext::DownloadContext()
   curl_easy_setopt(m_curl, CURLOPT_FAILONERROR, true);
   curl_easy_setopt(m_curl, CURLOPT_SHARE, g_curlShare);
   curl_easy_setopt(m_curl, CURLOPT_NOPROGRESS, false);
+#if LIBCURL_VERSION_NUM >= 0x072f00 // 7.47.0
+  curl_easy_setopt(m_curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+#endif
 }
 
 DownloadContext::~DownloadContext()
@@ -90,9 +115,68 @@ size_t Download::WriteData(char *data, size_t rawsize, size_t nmemb, void *ptr)
 {
   const size_t size = rawsize * nmemb;
 
-  static_cast<ostream *>(ptr)->write(data, size);
+  Download *dl = static_cast<Download *>(ptr);
+
+  if(!dl->m_receiving) {
+    dl->m_receiving = true;
+
+#if LIBCURL_VERSION_NUM >= 0x073700 // 7.55.0
+    curl_off_t length = -1;
+    curl_easy_getinfo(dl->m_ctx->m_curl,
+      CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+#else
+    double length = -1;
+    curl_easy_getinfo(dl->m_ctx->m_curl,
+      CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length);
+#endif
+
+    if(length > 0)
+      dl->reserveStream((int64_t)length);
+  }
+
+  if(!dl->writeStream(data, size))
+    return 0;
+
+  dl->m_hash.addData(data, size);
+  g_received += size;
 
-  return size;
+  // returning less than size stops the transfer
+  return dl->throttle(size) ? size : 0;
+}
+
+bool Download::throttle(const size_t received)
+{
+  using namespace chrono;
+
+  auto delay = steady_clock::duration::zero();
+
+  if(m_opts.maxSpeed) {
+    const double rate = m_opts.maxSpeed * 1024.0;
+    const auto now = steady_clock::now();
+
+    WDL_MutexLock lock(&g_bucketMutex);
+
+    // refill, allowing bursts of up to one second worth of data
+    const double elapsed = duration<double>(now - g_bucketTime).count();
+    g_bucketTokens = min(rate, g_bucketTokens + elapsed * rate) - received;
+    g_bucketTime = now;
+
+    if(g_bucketTokens < 0)
+      delay = duration_cast<steady_clock::duration>(
+        duration<double>(-g_bucketTokens / rate));
+  }
+
+  // yield the bandwidth to interactive downloads
+  if(has(BackgroundFlag) && g_foregroundDownloads > 0)
+    delay = max<steady_clock::duration>(delay, BACKGROUND_DELAY);
+
+  // sleep in small steps to stay responsive to cancellation
+  const auto until = steady_clock::now() + delay;
+  while(!aborted() && steady_clock::now() < until)
+    this_thread::sleep_for(min<steady_clock::duration>(
+      until - steady_clock::now(), milliseconds(100)));
+
+  return !aborted();
 }
 
 int Download::UpdateProgress(void *ptr, const double, const double,
@@ -102,8 +186,24 @@ int Download::UpdateProgress(void *ptr, const double, const double,
 }
 
 Download::Download(const string &url, const NetworkOpts &opts, const int flags)
-  : m_url(url), m_opts(opts), m_flags(flags), m_ctx(nullptr)
+  : m_url(url), m_opts(opts), m_flags(flags), m_ctx(nullptr),
+    m_receiving(false), m_stats{url}, m_httpStatus(0)
 {
+  setGroup(host(url), opts.hostConnections);
+}
+
+int64_t Download::totalReceived()
+{
+  return g_received;
+}
+
+string Download::host(const string &url)
+{
+  const size_t scheme = url.find("://");
+  const size_t start = scheme == string::npos ? 0 : scheme + 3;
+  const size_t end = url.find_first_of("/?#", start);
+
+  return url.substr(start, end == string::npos ? string::npos : end - start);
 }
 
 void Download::setName(const string &name)
@@ -113,10 +213,13 @@ void Download::setName(const string &name)
 
 bool Download::run()
 {
-  ostream *stream = openStream();
-  if(!stream)
+  Trace::Span span("Download::run", m_url);
+
+  if(!openStream())
     return false;
 
+  m_receiving = false;
+
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_URL, m_url.c_str());
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_PROXY, m_opts.proxy.c_str());
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_SSL_VERIFYPEER, m_opts.verifyPeer);
@@ -125,7 +228,9 @@ bool Download::run()
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_PROGRESSDATA, this);
 
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_WRITEFUNCTION, WriteData);
-  curl_easy_setopt(m_ctx->m_curl, CURLOPT_WRITEDATA, stream);
+  curl_easy_setopt(m_ctx->m_curl, CURLOPT_WRITEDATA, this);
+  curl_easy_setopt(m_ctx->m_curl, CURLOPT_BUFFERSIZE,
+    (long)m_opts.bufferSize * 1024);
 
   curl_slist *headers = nullptr;
   if(has(Download::NoCacheFlag))
@@ -135,9 +240,16 @@ bool Download::run()
   char errbuf[CURL_ERROR_SIZE] = "No error message";
   curl_easy_setopt(m_ctx->m_curl, CURLOPT_ERRORBUFFER, errbuf);
 
+  if(!has(BackgroundFlag))
+    ++g_foregroundDownloads;
+
   const CURLcode res = curl_easy_perform(m_ctx->m_curl);
   curl_slist_free_all(headers);
+
+  if(!has(BackgroundFlag))
+    --g_foregroundDownloads;
   closeStream();
+  readStats();
 
   if(res != CURLE_OK) {
     char err[255];
@@ -146,7 +258,36 @@ bool Download::run()
     return false;
   }
 
-  return true;
+  if(!m_checksum.empty() && m_hash.digest() != m_checksum) {
+    setError({"Checksum mismatch: the downloaded file is corrupted "
+      "or was modified", m_url});
+    return false;
+  }
+
+  return finishStream();
+}
+
+void Download::readStats()
+{
+  CURL *curl = m_ctx->m_curl;
+
+#if LIBCURL_VERSION_NUM >= 0x073700
+  curl_off_t size = 0;
+  curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &size);
+#else
+  double size = 0;
+  curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD, &size);
+#endif
+  m_stats.size = (int64_t)size;
+
+  curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME, &m_stats.nameLookup);
+  curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &m_stats.connect);
+  curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &m_stats.tlsHandshake);
+  curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME, &m_stats.firstByte);
+  curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &m_stats.total);
+
+  // also set when CURLOPT_FAILONERROR fails the transfer
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &m_httpStatus);
 }
 
 MemoryDownload::MemoryDownload(const string &url, const NetworkOpts &opts, int flags)
@@ -155,9 +296,32 @@ MemoryDownload::MemoryDownload(const string &url, const NetworkOpts &opts, int f
   setName(url);
 }
 
+bool MemoryDownload::writeStream(const char *data, const size_t len)
+{
+  // exceptions must not cross curl's callback nor end the worker thread
+  try {
+    m_contents.append(data, len);
+    return true;
+  }
+  catch(const bad_alloc &) {
+    return false; // fails the transfer with CURLE_WRITE_ERROR
+  }
+}
+
+void MemoryDownload::reserveStream(const int64_t size)
+{
+  if(size > MAX_MEMORY_RESERVE)
+    return;
+
+  try {
+    m_contents.reserve((size_t)size);
+  }
+  catch(const bad_alloc &) {}
+}
+
 FileDownload::FileDownload(const Path &target, const string &url,
     const NetworkOpts &opts, int flags)
-  : Download(url, opts, flags), m_path(target)
+  : Download(url, opts, flags), m_path(target), m_file(nullptr)
 {
   setName(target.join());
 }
@@ -170,17 +334,36 @@ bool FileDownload::save()
     return FS::remove(m_path.temp());
 }
 
-ostream *FileDownload::openStream()
+bool FileDownload::openStream()
 {
-  if(FS::open(m_stream, m_path.temp()))
-    return &m_stream;
-  else {
+  m_file = FS::create(m_path.temp());
+
+  if(!m_file) {
     setError({FS::lastError(), m_path.temp().join()});
-    return nullptr;
+    return false;
   }
+
+  // curl already hands over the data in large chunks
+  setvbuf(m_file, nullptr, _IONBF, 0);
+
+  return true;
+}
+
+bool FileDownload::writeStream(const char *data, const size_t len)
+{
+  return fwrite(data, 1, len, m_file) == len;
+}
+
+void FileDownload::reserveStream(const int64_t size)
+{
+  if(size <= MAX_FILE_RESERVE)
+    FS::allocate(m_file, size);
 }
 
 void FileDownload::closeStream()
 {
-  m_stream.close();
+  if(m_file) {
+    fclose(m_file);
+    m_file = nullptr;
+  }
 }
@@ -19,12 +19,13 @@
 #define REAPACK_DOWNLOAD_HPP
 
 #include "config.hpp"
+#include "hash.hpp"
 #include "path.hpp"
+#include "receipt.hpp"
 #include "thread.hpp"
 
+#include <cstdio>
 #include <curl/curl.h>
-#include <fstream>
-#include <sstream>
 
 struct DownloadContext {
   static void GlobalInit();
@@ -39,44 +40,67 @@ struct DownloadContext {
 class Download : public ThreadTask {
 public:
   enum Flag {
-    NoCacheFlag = 1<<0,
+    NoCacheFlag    = 1<<0,
+    BackgroundFlag = 1<<1, // slowed down while other downloads are running
   };
 
+  static std::string host(const std::string &url);
+  // bytes received by every download so far
+  static int64_t totalReceived();
+
   Download(const std::string &url, const NetworkOpts &, int flags = 0);
 
   void setName(const std::string &);
   const std::string &url() const { return m_url; }
+  // the data is hashed as it arrives and rejected if it does not match
+  void setChecksum(const std::string &sha256) { m_checksum = sha256; }
+  const std::string &digest() { return m_hash.digest(); }
+  const DownloadStats &stats() const { return m_stats; }
+  long httpStatus() const { return m_httpStatus; }
   void setContext(DownloadContext *ctx) { m_ctx = ctx; }
 
   bool concurrent() const override { return true; }
   bool run() override;
 
 protected:
-  virtual std::ostream *openStream() = 0;
+  virtual bool openStream() = 0;
+  virtual bool writeStream(const char *, size_t) = 0;
+  virtual void reserveStream(int64_t) {} // expected size when known
   virtual void closeStream() {}
+  // post-processing of a complete transfer, still in the worker thread
+  virtual bool finishStream() { return true; }
 
 private:
   bool has(Flag f) const { return (m_flags & f) != 0; }
   static size_t WriteData(char *, size_t, size_t, void *);
+  bool throttle(size_t received);
+  void readStats();
   static int UpdateProgress(void *, double, double, double, double);
 
   std::string m_url;
+  std::string m_checksum;
   NetworkOpts m_opts;
   int m_flags;
   DownloadContext *m_ctx;
+  bool m_receiving;
+  Hash m_hash;
+  DownloadStats m_stats;
+  long m_httpStatus;
 };
 
 class MemoryDownload : public Download {
 public:
   MemoryDownload(const std::string &url, const NetworkOpts &, int flags = 0);
 
-  std::string contents() const { return m_stream.str(); }
+  const std::string &contents() const { return m_contents; }
 
 protected:
-  std::ostream *openStream() override { return &m_stream; }
+  bool openStream() override { m_contents.clear(); return true; }
+  bool writeStream(const char *, size_t) override;
+  void reserveStream(int64_t) override;
 
 private:
-  std::stringstream m_stream;
+  std::string m_contents;
 };
 
 class FileDownload : public Download {
@@ -88,12 +112,14 @@ public:
   bool save();
 
 protected:
-  std::ostream *openStream() override;
+  bool openStream() override;
+  bool writeStream(const char *, size_t) override;
+  void reserveStream(int64_t) override;
   void closeStream() override;
 
 private:
   TempPath m_path;
-  std::ofstream m_stream;
+  FILE *m_file;
 };
 
 #endif
@@ -28,8 +28,11 @@
 #include <reaper_plugin_functions.h>
 
 #ifdef _WIN32
+#  include <io.h>
 #  include <windows.h>
-#  define stat _stat
+#  define stat _stat64 // 64-bit st_size, for files larger than 2 GiB
+#else
+#  include <fcntl.h>
 #endif
 
 using namespace std;
@@ -39,7 +42,7 @@ static bool stat(const Path &path, struct stat *out)
   const auto &&fullPath = Win32::widen(path.prependRoot().join());
 
 #ifdef _WIN32
-  constexpr auto func = &_wstat;
+  constexpr auto func = &_wstat64;
 #else
   constexpr int(*func)(const char *, struct stat *) = &::stat;
 #endif
@@ -60,6 +63,22 @@ FILE *FS::open(const Path &path)
 #endif
 }
 
+FILE *FS::create(const Path &path)
+{
+  if(!mkdir(path.dirname()))
+    return nullptr;
+
+  const auto &&fullPath = Win32::widen(path.prependRoot().join());
+
+#ifdef _WIN32
+  FILE *file = nullptr;
+  _wfopen_s(&file, fullPath.c_str(), L"wb");
+  return file;
+#else
+  return fopen(fullPath.c_str(), "wb");
+#endif
+}
+
 bool FS::open(ifstream &stream, const Path &path)
 {
   const auto &&fullPath = Win32::widen(path.prependRoot().join());
@@ -77,6 +96,17 @@ bool FS::open(ofstream &stream, const Path &path)
   return stream.good();
 }
 
+bool FS::read(const Path &path, string *contents)
+{
+  ifstream file;
+  if(!open(file, path))
+    return false;
+
+  contents->assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+
+  return !file.bad();
+}
+
 bool FS::write(const Path &path, const string &contents)
 {
   ofstream file;
@@ -169,6 +199,18 @@ bool FS::mtime(const Path &path, time_t *time)
   return true;
 }
 
+bool FS::size(const Path &path, int64_t *size)
+{
+  struct stat st;
+
+  if(!stat(path, &st))
+    return false;
+
+  *size = st.st_size;
+
+  return true;
+}
+
 bool FS::exists(const Path &path, const bool dir)
 {
   struct stat st;
@@ -213,6 +255,24 @@ bool FS::mkdir(const Path &path)
   return true;
 }
 
+bool FS::allocate(FILE *file, const int64_t size)
+{
+  // reserve the disk space without changing the size of the file
+#ifdef _WIN32
+  FILE_ALLOCATION_INFO info{};
+  info.AllocationSize.QuadPart = size;
+
+  const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+  return SetFileInformationByHandle(handle, FileAllocationInfo,
+    &info, sizeof(info)) != 0;
+#elif defined(__APPLE__)
+  fstore_t store{F_ALLOCATEALL, F_PEOFPOSMODE, 0, size, 0};
+  return fcntl(fileno(file), F_PREALLOCATE, &store) != -1;
+#else
+  return !fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, 0, size);
+#endif
+}
+
 const char *FS::lastError()
 {
   return strerror(errno);
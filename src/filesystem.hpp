@@ -26,17 +26,21 @@ class TempPath;
 
 namespace FS {
   FILE *open(const Path &);
+  FILE *create(const Path &);
   bool open(std::ifstream &, const Path &);
   bool open(std::ofstream &, const Path &);
+  bool read(const Path &, std::string *);
   bool write(const Path &, const std::string &);
   bool rename(const TempPath &);
   bool rename(const Path &, const Path &);
   bool remove(const Path &);
   bool removeRecursive(const Path &);
   bool mtime(const Path &, time_t *);
+  bool size(const Path &, int64_t *);
   bool exists(const Path &, bool dir = false);
   bool allFilesExists(const std::set<Path> &);
   bool mkdir(const Path &);
+  bool allocate(FILE *, int64_t size);
 
   const char *lastError();
 };
@@ -17,6 +17,9 @@
 
 #include "filter.hpp"
 
+#include "trigram.hpp"
+
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 
 using namespace std;
@@ -72,6 +75,12 @@ bool Filter::match(vector<string> rows) const
   return m_root.match(rows);
 }
 
+bool Filter::candidates(const TrigramIndex &index, vector<size_t> *out) const
+{
+  out->clear();
+  return m_root.candidates(index, out);
+}
+
 Filter::Group::Group(Type type, int flags, Group *parent)
   : Node(flags), m_parent(parent), m_type(type), m_open(true)
 {
@@ -159,6 +168,46 @@ bool Filter::Group::match(const vector<string> &rows) const
   return m_type == MatchAll && !test(NotFlag);
 }
 
+bool Filter::Group::candidates(const TrigramIndex &index, vector<size_t> *out) const
+{
+  // negated groups may match anything not containing their tokens
+  if(test(NotFlag))
+    return false;
+
+  bool narrowed = false;
+  vector<size_t> nodeDocs, merged;
+
+  for(const NodePtr &node : m_nodes) {
+    if(!node->candidates(index, &nodeDocs)) {
+      if(m_type == MatchAny)
+        return false; // one unbounded alternative is enough to match anything
+
+      continue;
+    }
+
+    if(!narrowed) {
+      out->swap(nodeDocs);
+      narrowed = true;
+      continue;
+    }
+
+    merged.clear();
+
+    if(m_type == MatchAll) {
+      set_intersection(out->begin(), out->end(),
+        nodeDocs.begin(), nodeDocs.end(), back_inserter(merged));
+    }
+    else {
+      set_union(out->begin(), out->end(),
+        nodeDocs.begin(), nodeDocs.end(), back_inserter(merged));
+    }
+
+    out->swap(merged);
+  }
+
+  return narrowed;
+}
+
 Filter::Token::Token(const string &buf, int flags)
   : Node(flags), m_buf(buf)
 {
@@ -180,6 +229,14 @@ bool Filter::Token::match(const vector<string> &rows) const
   return match;
 }
 
+bool Filter::Token::candidates(const TrigramIndex &index, vector<size_t> *out) const
+{
+  if(test(NotFlag))
+    return false;
+
+  return index.lookup(m_buf, out);
+}
+
 bool Filter::Token::matchRow(const string &str) const
 {
   const size_t pos = str.find(m_buf);
@@ -22,6 +22,8 @@
 #include <string>
 #include <vector>
 
+class TrigramIndex;
+
 class Filter {
 public:
   Filter(const std::string & = {});
@@ -29,8 +31,15 @@ public:
   const std::string get() const { return m_input; }
   void set(const std::string &);
 
+  // every row matches an empty filter
+  bool empty() const { return m_root.empty(); }
   bool match(std::vector<std::string> rows) const;
 
+  // Pre-selects the documents of the index that could match the filter
+  // (they must still be verified using match). Returns false if the filter
+  // cannot be narrowed down and every document is a candidate.
+  bool candidates(const TrigramIndex &, std::vector<size_t> *out) const;
+
   Filter &operator=(const std::string &f) { set(f); return *this; }
   bool operator==(const std::string &f) const { return m_input == f; }
   bool operator!=(const std::string &f) const { return !(*this == f); }
@@ -49,6 +58,7 @@ private:
     Node(int flags) : m_flags(flags) {}
 
     virtual bool match(const std::vector<std::string> &) const = 0;
+    virtual bool candidates(const TrigramIndex &, std::vector<size_t> *) const = 0;
     bool test(Flag f) const { return (m_flags & f) != 0; }
 
   private:
@@ -66,8 +76,10 @@ private:
 
     Group(Type type, int flags = 0, Group *parent = nullptr);
     void clear() { m_nodes.clear(); }
+    bool empty() const { return m_nodes.empty(); }
     Group *push(std::string, int *flags);
     bool match(const std::vector<std::string> &) const override;
+    bool candidates(const TrigramIndex &, std::vector<size_t> *) const override;
 
   private:
     void push(const NodePtr &);
@@ -82,6 +94,7 @@ private:
   public:
     Token(const std::string &buf, int flags);
     bool match(const std::vector<std::string> &) const override;
+    bool candidates(const TrigramIndex &, std::vector<size_t> *) const override;
     bool matchRow(const std::string &) const;
 
   private:
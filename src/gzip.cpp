@@ -0,0 +1,105 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "gzip.hpp"
+
+#include <zlib/zlib.h>
+
+using namespace std;
+
+static const int GZIP_WINDOW = 16 + MAX_WBITS;
+static const size_t CHUNK_SIZE = 16384;
+
+bool Gzip::isCompressed(const string &data)
+{
+  return isCompressed(data.data(), data.size());
+}
+
+bool Gzip::isCompressed(const char *data, const size_t size)
+{
+  return size >= 2 && data[0] == '\x1f' && data[1] == '\x8b';
+}
+
+bool Gzip::compress(const string &input, string *output)
+{
+  z_stream stream{};
+
+  // The cache is rewritten on every index change, favor speed over ratio.
+  // XML compresses well enough at any level.
+  if(deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED,
+      GZIP_WINDOW, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+
+  string result(deflateBound(&stream, input.size()), 0);
+
+  stream.next_in = (Bytef *)input.data();
+  stream.avail_in = (uInt)input.size();
+  stream.next_out = (Bytef *)&result[0];
+  stream.avail_out = (uInt)result.size();
+
+  const int status = deflate(&stream, Z_FINISH);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+
+  if(status != Z_STREAM_END)
+    return false;
+
+  output->swap(result);
+  return true;
+}
+
+bool Gzip::decompress(const string &input, string *output)
+{
+  return decompress(input.data(), input.size(), output);
+}
+
+bool Gzip::decompress(const char *input, const size_t size, string *output)
+{
+  z_stream stream{};
+
+  if(inflateInit2(&stream, GZIP_WINDOW) != Z_OK)
+    return false;
+
+  stream.next_in = (Bytef *)input;
+  stream.avail_in = (uInt)size;
+
+  string result;
+  char chunk[CHUNK_SIZE];
+  int status;
+
+  do {
+    stream.next_out = (Bytef *)chunk;
+    stream.avail_out = sizeof(chunk);
+
+    status = inflate(&stream, Z_NO_FLUSH);
+
+    if(status != Z_OK && status != Z_STREAM_END)
+      break;
+
+    result.append(chunk, sizeof(chunk) - stream.avail_out);
+  } while(status != Z_STREAM_END);
+
+  const bool complete = status == Z_STREAM_END && stream.avail_in == 0;
+  inflateEnd(&stream);
+
+  if(!complete)
+    return false;
+
+  output->swap(result);
+  return true;
+}
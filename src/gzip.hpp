@@ -0,0 +1,37 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAPACK_GZIP_HPP
+#define REAPACK_GZIP_HPP
+
+#include <string>
+
+// gzip (RFC 1952) helpers used for compressed index transfer and storage.
+namespace Gzip {
+  bool isCompressed(const std::string &data);
+  bool isCompressed(const char *data, size_t size);
+
+  bool compress(const std::string &input, std::string *output);
+
+  // Inflates the input in fixed-size chunks. Trailing data after the
+  // first member and truncated streams are reported as errors.
+  bool decompress(const std::string &input, std::string *output);
+  bool decompress(const char *input, size_t size, std::string *output);
+};
+
+#endif
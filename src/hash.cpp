@@ -0,0 +1,138 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hash.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+  0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+  0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+  0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+  0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+  0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(const uint32_t x, const int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+string Hash::sha256(const string &data)
+{
+  Hash hash;
+  hash.addData(data);
+  return hash.digest();
+}
+
+Hash::Hash()
+  : m_state{{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}},
+    m_bufferSize(0), m_length(0)
+{
+}
+
+void Hash::addData(const char *data, size_t len)
+{
+  m_length += len;
+
+  while(len > 0) {
+    const size_t chunk = min(len, m_buffer.size() - m_bufferSize);
+    memcpy(&m_buffer[m_bufferSize], data, chunk);
+
+    m_bufferSize += chunk;
+    data += chunk;
+    len -= chunk;
+
+    if(m_bufferSize == m_buffer.size()) {
+      transform(m_buffer.data());
+      m_bufferSize = 0;
+    }
+  }
+}
+
+const string &Hash::digest()
+{
+  if(!m_digest.empty())
+    return m_digest;
+
+  const uint64_t bitLength = m_length * 8;
+
+  const char padding = '\x80';
+  addData(&padding, 1);
+
+  const char zero = 0;
+  while(m_bufferSize != 56)
+    addData(&zero, 1);
+
+  for(int i = 7; i >= 0; --i) {
+    const char byte = static_cast<char>(bitLength >> (i * 8));
+    addData(&byte, 1);
+  }
+
+  static const char hex[] = "0123456789abcdef";
+  m_digest.reserve(64);
+
+  for(const uint32_t word : m_state) {
+    for(int i = 28; i >= 0; i -= 4)
+      m_digest += hex[(word >> i) & 0xf];
+  }
+
+  return m_digest;
+}
+
+void Hash::transform(const uint8_t *block)
+{
+  uint32_t w[64];
+
+  for(int i = 0; i < 16; ++i) {
+    w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16 |
+      (uint32_t)block[i * 4 + 2] << 8 | (uint32_t)block[i * 4 + 3];
+  }
+
+  for(int i = 16; i < 64; ++i) {
+    const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = m_state[0], b = m_state[1], c = m_state[2], d = m_state[3],
+           e = m_state[4], f = m_state[5], g = m_state[6], h = m_state[7];
+
+  for(int i = 0; i < 64; ++i) {
+    const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+    const uint32_t ch = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + ch + K[i] + w[i];
+    const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+    const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + maj;
+
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  m_state[0] += a; m_state[1] += b; m_state[2] += c; m_state[3] += d;
+  m_state[4] += e; m_state[5] += f; m_state[6] += g; m_state[7] += h;
+}
@@ -0,0 +1,48 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_HASH_HPP
+#define REAPACK_HASH_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Incremental SHA-256. Data can be added in chunks of any size.
+class Hash {
+public:
+  static std::string sha256(const std::string &data);
+
+  Hash();
+
+  void addData(const char *data, size_t len);
+  void addData(const std::string &data) { addData(data.data(), data.size()); }
+
+  // Hexadecimal representation of the digest. No more data can be added.
+  const std::string &digest();
+
+private:
+  void transform(const uint8_t *block);
+
+  std::array<uint32_t, 8> m_state;
+  std::array<uint8_t, 64> m_buffer;
+  size_t m_bufferSize;
+  uint64_t m_length;
+  std::string m_digest;
+};
+
+#endif
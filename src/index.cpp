@@ -19,9 +19,13 @@
 
 #include "errors.hpp"
 #include "filesystem.hpp"
+#include "gzip.hpp"
+#include "mapped_file.hpp"
 #include "path.hpp"
 #include "remote.hpp"
+#include "trace.hpp"
 
+#include <cstring>
 #include <WDL/tinyxml/tinyxml.h>
 
 using namespace std;
@@ -31,20 +35,66 @@ Path Index::pathFor(const string &name)
   return Path::CACHE + (name + ".xml");
 }
 
+Path Index::hashPathFor(const string &name)
+{
+  return Path::CACHE + (name + ".sha256");
+}
+
+// TiXmlDocument::LoadFile does this before parsing but Parse does not
+static void normalizeNewlines(string *text)
+{
+  size_t out = 0;
+
+  for(size_t in = 0; in < text->size(); ++in) {
+    const char c = (*text)[in];
+
+    if(c == '\r') {
+      (*text)[out++] = '\n';
+
+      if(in + 1 < text->size() && (*text)[in + 1] == '\n')
+        ++in;
+    }
+    else
+      (*text)[out++] = c;
+  }
+
+  text->resize(out);
+}
+
 IndexPtr Index::load(const string &name, const char *data)
 {
+  Trace::Span span("Index::load", name);
   TiXmlDocument doc;
 
   if(data)
     doc.Parse(data);
   else {
-    FILE *file = FS::open(pathFor(name));
-
-    if(!file)
+    const MappedFile file(pathFor(name));
+    if(!file.isOpen())
       throw reapack_error(FS::lastError());
 
-    doc.LoadFile(file);
-    fclose(file);
+    // parse straight from the mapping if possible, TinyXML makes its own copies
+    const char *text = file.data();
+    string contents;
+
+    // the cached copy is normally stored compressed
+    if(Gzip::isCompressed(file.data(), file.size())) {
+      if(!Gzip::decompress(file.data(), file.size(), &contents))
+        throw reapack_error("corrupted index cache");
+
+      text = nullptr;
+    }
+    else if(!file.isTerminated() || memchr(file.data(), '\r', file.size())) {
+      contents.assign(file.data(), file.size());
+      text = nullptr;
+    }
+
+    if(!text) {
+      normalizeNewlines(&contents);
+      text = contents.c_str();
+    }
+
+    doc.Parse(text);
   }
 
   if(doc.ErrorId())
@@ -39,6 +39,8 @@ typedef std::shared_ptr<const Index> IndexPtr;
 class Index : public std::enable_shared_from_this<const Index> {
 public:
   static Path pathFor(const std::string &name);
+  // SHA-256 of the uncompressed cached index, saved by SynchronizeTask
+  static Path hashPathFor(const std::string &name);
   static IndexPtr load(const std::string &name, const char *data = nullptr);
 
   Index(const std::string &name);
@@ -0,0 +1,141 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "index_delta.hpp"
+
+#include "errors.hpp"
+#include "hash.hpp"
+
+#include <sstream>
+
+using namespace std;
+
+static const string MAGIC = "RPDELTA 1\n";
+
+static size_t readLength(istream &stream)
+{
+  // parsed as signed so that "-1" is rejected instead of wrapping around
+  long long value;
+  if(!(stream >> value) || value < 0)
+    throw reapack_error("corrupted index delta");
+
+  return static_cast<size_t>(value);
+}
+
+bool IndexDelta::isDelta(const string &data)
+{
+  return !data.compare(0, MAGIC.size(), MAGIC);
+}
+
+string IndexDelta::create(const string &base, const string &target)
+{
+  const size_t maxCommon = min(base.size(), target.size());
+
+  size_t prefix = 0;
+  while(prefix < maxCommon && base[prefix] == target[prefix])
+    ++prefix;
+
+  size_t suffix = 0;
+  while(suffix < maxCommon - prefix &&
+      base[base.size() - suffix - 1] == target[target.size() - suffix - 1])
+    ++suffix;
+
+  ostringstream stream;
+  stream << MAGIC << Hash::sha256(base) << '\n' << Hash::sha256(target) << '\n';
+
+  if(prefix)
+    stream << "C 0 " << prefix << '\n';
+
+  const size_t insertSize = target.size() - prefix - suffix;
+  if(insertSize) {
+    stream << "I " << insertSize << '\n';
+    stream.write(&target[prefix], insertSize);
+  }
+
+  if(suffix)
+    stream << "C " << base.size() - suffix << ' ' << suffix << '\n';
+
+  return stream.str();
+}
+
+IndexDelta::IndexDelta(const string &data)
+{
+  if(!isDelta(data))
+    throw reapack_error("invalid delta header");
+
+  istringstream stream(data);
+  stream.seekg(MAGIC.size());
+
+  stream >> m_baseHash >> m_targetHash;
+
+  char type;
+  while(stream >> type) {
+    Operation op{};
+
+    switch(type) {
+    case 'C':
+      op.offset = readLength(stream);
+      op.length = readLength(stream);
+      break;
+    case 'I':
+      op.length = readLength(stream);
+
+      // the length comes from the server: don't allocate more than what is
+      // left in the input
+      if(stream.get() != '\n' ||
+          op.length > data.size() - static_cast<size_t>(stream.tellg()))
+        throw reapack_error("corrupted index delta");
+
+      op.data.resize(op.length);
+      if(!stream.read(&op.data[0], op.length))
+        throw reapack_error("corrupted index delta");
+      break;
+    default:
+      stream.setstate(ios::failbit);
+      break;
+    }
+
+    if(!stream)
+      throw reapack_error("invalid delta operation");
+
+    m_operations.push_back(move(op));
+  }
+}
+
+string IndexDelta::apply(const string &base) const
+{
+  if(Hash::sha256(base) != m_baseHash)
+    throw reapack_error("delta base mismatch");
+
+  string target;
+
+  for(const Operation &op : m_operations) {
+    if(op.data.empty()) {
+      if(op.offset > base.size() || op.length > base.size() - op.offset)
+        throw reapack_error("delta copy out of range");
+
+      target.append(base, op.offset, op.length);
+    }
+    else
+      target += op.data;
+  }
+
+  if(Hash::sha256(target) != m_targetHash)
+    throw reapack_error("delta target mismatch");
+
+  return target;
+}
@@ -0,0 +1,56 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_INDEX_DELTA_HPP
+#define REAPACK_INDEX_DELTA_HPP
+
+#include <string>
+#include <vector>
+
+// Patch turning a cached index file into its latest revision.
+//
+//   RPDELTA 1
+//   <SHA-256 of the base file>
+//   <SHA-256 of the resulting file>
+//   C <offset> <length>       copy a range of the base file
+//   I <length>                insert the next <length> bytes
+//   <bytes>
+class IndexDelta {
+public:
+  static bool isDelta(const std::string &data);
+  static std::string create(const std::string &base, const std::string &target);
+
+  IndexDelta(const std::string &data);
+
+  const std::string &baseHash() const { return m_baseHash; }
+  const std::string &targetHash() const { return m_targetHash; }
+
+  std::string apply(const std::string &base) const;
+
+private:
+  struct Operation {
+    size_t offset; // copy only
+    size_t length;
+    std::string data; // insert only
+  };
+
+  std::string m_baseHash;
+  std::string m_targetHash;
+  std::vector<Operation> m_operations;
+};
+
+#endif
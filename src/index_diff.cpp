@@ -0,0 +1,68 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "index_diff.hpp"
+
+#include "index.hpp"
+
+using namespace std;
+
+IndexDiff::IndexDiff(const Index *before, const Index *after)
+{
+  for(const Package *pkg : after->packages()) {
+    const Package *old = before ?
+      before->find(pkg->category()->name(), pkg->name()) : nullptr;
+
+    if(!old)
+      m_changes.push_back({Added, nullptr, pkg});
+    else if(!equal(old, pkg))
+      m_changes.push_back({Modified, old, pkg});
+    else
+      continue;
+
+    m_changed.insert(pkg);
+  }
+
+  if(!before)
+    return;
+
+  for(const Package *pkg : before->packages()) {
+    if(!after->find(pkg->category()->name(), pkg->name()))
+      m_changes.push_back({Removed, pkg, nullptr});
+  }
+}
+
+bool IndexDiff::equal(const Package *l, const Package *r)
+{
+  if(l->type() != r->type() || l->description() != r->description() ||
+      l->versions().size() != r->versions().size())
+    return false;
+
+  auto lit = l->versions().begin();
+  auto rit = r->versions().begin();
+
+  for(; lit != l->versions().end(); ++lit, ++rit) {
+    const Version *lver = *lit, *rver = *rit;
+
+    if(lver->name().toString() != rver->name().toString() ||
+        lver->author() != rver->author() ||
+        lver->time() != rver->time())
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,57 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_INDEX_DIFF_HPP
+#define REAPACK_INDEX_DIFF_HPP
+
+#include <unordered_set>
+#include <vector>
+
+class Index;
+class Package;
+
+// Lists the packages added, removed or modified between two revisions of an
+// index. Only what the user can see is compared: the package's type and
+// description and the name, author and date of each version.
+class IndexDiff {
+public:
+  enum ChangeType {
+    Added,
+    Removed,
+    Modified,
+  };
+
+  struct Change {
+    ChangeType type;
+    const Package *before; // null if added
+    const Package *after;  // null if removed
+  };
+
+  IndexDiff(const Index *before, const Index *after);
+
+  const std::vector<Change> &changes() const { return m_changes; }
+  bool empty() const { return m_changes.empty(); }
+  bool changed(const Package *after) const { return m_changed.count(after) > 0; }
+
+private:
+  static bool equal(const Package *, const Package *);
+
+  std::vector<Change> m_changes;
+  std::unordered_set<const Package *> m_changed;
+};
+
+#endif
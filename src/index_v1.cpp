@@ -182,12 +182,17 @@ void LoadSourceV1(TiXmlElement *node, Version *ver)
   const char *url = node->GetText();
   if(!url) url = "";
 
+  const char *hash = node->Attribute("hash");
+
   Source *src = new Source(file, url, ver);
   unique_ptr<Source> ptr(src);
 
   src->setPlatform(platform);
   src->setTypeOverride(Package::getType(type));
 
+  if(hash)
+    src->setChecksum(hash);
+
   int sections = 0;
   string section;
   istringstream mainStream(main);
@@ -21,16 +21,71 @@
 #include "config.hpp"
 #include "download.hpp"
 #include "filesystem.hpp"
+#include "hash.hpp"
 #include "index.hpp"
 #include "reapack.hpp"
 #include "transaction.hpp"
 
+#include <fstream>
+
 using namespace std;
 
+// Sizes are known from the files installed by the previous version,
+// new files are treated as empty.
+static int64_t downloadPriority(const int64_t size)
+{
+  switch(g_reapack->config()->network.downloadOrder) {
+  case NetworkOpts::LargestFirst:
+    return size;
+  case NetworkOpts::SmallestFirst:
+    return -size;
+  default:
+    return 0;
+  }
+}
+
+// Hashes an installed file whose state isn't known from the registry,
+// off the main thread as it may be large.
+class FileHasher : public ThreadTask {
+public:
+  FileHasher(const Path &path) : m_path(path)
+  {
+    setSummary("Checking %s: " + path.join());
+    setOptional(true); // the file is fetched again if it can't be read
+  }
+
+  const string &hash() const { return m_hash; }
+  bool concurrent() const override { return true; }
+
+protected:
+  bool run() override
+  {
+    ifstream file;
+    if(!FS::open(file, m_path))
+      return false;
+
+    Hash hash;
+    char buffer[16384];
+
+    while(file.read(buffer, sizeof(buffer)) || file.gcount())
+      hash.addData(buffer, file.gcount());
+
+    if(file.bad())
+      return false;
+
+    m_hash = hash.digest();
+    return true;
+  }
+
+private:
+  Path m_path;
+  string m_hash;
+};
+
 InstallTask::InstallTask(const Version *ver, const bool pin,
     const Registry::Entry &re, const ArchiveReaderPtr &reader, Transaction *tx)
   : Task(tx), m_version(ver), m_pin(pin), m_oldEntry(move(re)), m_reader(reader),
-    m_fail(false), m_index(ver->package()->category()->index()->shared_from_this())
+    m_fail(false), m_replaced(false), m_index(ver->package()->category()->index()->shared_from_this())
 {
 }
 
@@ -58,61 +113,160 @@ bool InstallTask::start()
     return false;
   }
 
+  const bool sameVersion = m_oldEntry.version == m_version->name();
+
   for(const Source *src : m_version->sources()) {
     const Path &targetPath = src->targetPath();
 
     const auto &old = find_if(m_oldFiles.begin(), m_oldFiles.end(),
       [&](const Registry::File &f) { return f.path == targetPath; });
 
-    if(old != m_oldFiles.end())
+    int64_t expectedSize = 0;
+    bool knownHash = false;
+
+    if(old != m_oldFiles.end()) {
+      expectedSize = old->size;
+
+      // files left untouched since they were installed can be kept if they
+      // match the source's checksum or, without one, if the version is the same
+      const bool unchanged = old->isUnchanged();
+      knownHash = unchanged && !old->hash.empty();
+
+      bool keep = false;
+      if(unchanged) {
+        if(!src->checksum().empty())
+          keep = old->hash == src->checksum();
+        else
+          keep = sameVersion;
+      }
+
+      const string hash = old->hash;
       m_oldFiles.erase(old);
 
-    if(m_reader) {
-      FileExtractor *ex = new FileExtractor(targetPath, m_reader);
-      push(ex, ex->path());
+      if(keep) {
+        m_hashes[targetPath] = hash;
+        continue;
+      }
     }
-    else {
-      const NetworkOpts &opts = g_reapack->config()->network;
-      FileDownload *dl = new FileDownload(targetPath, src->url(), opts);
-      push(dl, dl->path());
+
+    if(knownHash || src->checksum().empty() || !FS::exists(targetPath)) {
+      fetch(src, expectedSize);
+      continue;
     }
+
+    // the file may already be the right one
+    FileHasher *hasher = new FileHasher(targetPath);
+    hasher->onFinish([=] {
+      if(m_fail || tx()->isCancelled() || hasher->state() == ThreadTask::Aborted)
+        return;
+      else if(hasher->state() == ThreadTask::Success &&
+          hasher->hash() == src->checksum())
+        m_hashes[targetPath] = src->checksum();
+      else
+        fetch(src, expectedSize); // before wait() checks for the last job
+    });
+    wait(hasher);
   }
 
   return true;
 }
 
+void InstallTask::fetch(const Source *src, const int64_t expectedSize)
+{
+  const Path &targetPath = src->targetPath();
+
+  if(m_reader) {
+    FileExtractor *ex = new FileExtractor(targetPath, m_reader);
+    push(ex, ex->path());
+  }
+  else {
+    const NetworkOpts &opts = g_reapack->config()->network;
+    FileDownload *dl = new FileDownload(targetPath, src->url(), opts);
+    dl->setChecksum(src->checksum());
+    dl->setPriority(downloadPriority(expectedSize));
+    dl->onFinish([=] {
+      if(dl->state() == ThreadTask::Success)
+        m_hashes[targetPath] = dl->digest();
+    });
+    push(dl, dl->path());
+  }
+}
+
 void InstallTask::push(ThreadTask *job, const TempPath &path)
 {
   job->onStart([=] { m_newFiles.push_back(path); });
+  wait(job);
+}
+
+void InstallTask::wait(ThreadTask *job)
+{
   job->onFinish([=] {
     m_waiting.erase(job);
 
-    if(job->state() != ThreadTask::Success)
+    if(job->state() != ThreadTask::Success && !job->optional())
       rollback();
+    else if(m_waiting.empty() && !m_fail && !tx()->isCancelled()) {
+      // move the files in place now instead of waiting for every other
+      // package, the replaced files are kept until commit() or rollback()
+      replaceFiles();
+    }
   });
 
   m_waiting.insert(job);
   tx()->threadPool()->push(job);
 }
 
-void InstallTask::commit()
+// Replaced files are kept in the transaction's own directory so that no
+// file of the user is overwritten and nothing is left next to the targets.
+Path InstallTask::backupPath(const Path &target) const
 {
-  if(m_fail)
-    return;
+  return tx()->backupDir() + target;
+}
+
+bool InstallTask::replaceFiles()
+{
+  m_replaced = true;
 
   for(const TempPath &paths : m_newFiles) {
-    if(!FS::rename(paths)) {
+    const Path &backup = backupPath(paths.target());
+
+    if(FS::exists(paths.target())) {
+      // never overwrite a file that could not be restored by rollback()
+      if(!FS::mkdir(backup.dirname()) || !FS::rename(paths.target(), backup)) {
+        tx()->receipt()->addError({
+          String::format("Cannot backup file: %s", FS::lastError()),
+          paths.target().join()});
+
+        rollback();
+        return false;
+      }
+
+      m_backups.push_back(paths.target());
+    }
+
+    if(FS::rename(paths))
+      m_replacedFiles.push_back(paths.target());
+    else {
       tx()->receipt()->addError({
         String::format("Cannot rename to target: %s", FS::lastError()),
         paths.target().join()});
 
-      // it's a bit late to rollback here as some files might already have been
-      // overwritten. at least we can delete the temporary files
       rollback();
-      return;
+      return false;
     }
   }
 
+  return true;
+}
+
+void InstallTask::commit()
+{
+  if(m_fail || (!m_replaced && !replaceFiles()))
+    return;
+
+  for(const Path &target : m_backups)
+    FS::removeRecursive(backupPath(target));
+
   for(const Registry::File &file : m_oldFiles) {
     if(FS::remove(file.path))
       tx()->receipt()->addRemoval(file.path);
@@ -124,6 +278,13 @@ void InstallTask::commit()
 
   const Registry::Entry newEntry = tx()->registry()->push(m_version);
 
+  for(Registry::File file : tx()->registry()->getFiles(newEntry)) {
+    FS::size(file.path, &file.size);
+    FS::mtime(file.path, &file.mtime);
+    file.hash = m_hashes[file.path];
+    tx()->registry()->setFileState(file);
+  }
+
   if(m_pin)
     tx()->registry()->setPinned(newEntry, true);
 
@@ -132,6 +293,22 @@ void InstallTask::commit()
 
 void InstallTask::rollback()
 {
+  if(m_replaced) {
+    // undo replaceFiles: new files are removed and replaced ones restored
+    for(const Path &target : m_replacedFiles)
+      FS::remove(target);
+
+    for(const Path &target : m_backups) {
+      const Path &backup = backupPath(target);
+      if(FS::rename(backup, target))
+        FS::removeRecursive(backup.dirname()); // empty directories
+    }
+
+    m_replacedFiles.clear();
+    m_backups.clear();
+    m_replaced = false;
+  }
+
   for(const TempPath &paths : m_newFiles)
     FS::removeRecursive(paths.temp());
 
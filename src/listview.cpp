@@ -20,6 +20,7 @@
 #include "iconlist.hpp"
 #include "menu.hpp"
 #include "time.hpp"
+#include "trigram.hpp"
 #include "version.hpp"
 #include "win32.hpp"
 
@@ -42,7 +43,10 @@ static int adjustWidth(const int points)
 }
 
 ListView::ListView(HWND handle, const Columns &columns)
-  : Control(handle), m_dirty(0), m_customizable(false), m_sort(), m_defaultSort()
+  : Control(handle),
+    m_virtual((GetWindowLong(handle, GWL_STYLE) & LVS_OWNERDATA) != 0),
+    m_dirty(0), m_filterIndex(nullptr),
+    m_customizable(false), m_sort(), m_defaultSort()
 {
   for(const Column &col : columns)
     addColumn(col);
@@ -94,14 +98,37 @@ int ListView::addColumn(const Column &col)
 auto ListView::createRow(void *data) -> RowPtr
 {
   const int index = rowCount();
-  insertItem(index, index);
+
+  if(!m_virtual)
+    insertItem(index, index);
 
   RowPtr row = make_shared<Row>(data, this);
   m_rows.push_back(row);
 
+  if(m_virtual) {
+    // the item count is updated once in filter()
+    row->viewIndex = (int)m_view.size();
+    m_view.push_back(index);
+    m_dirty |= NeedFilterFlag | NeedSortFlag;
+  }
+
+  if(!m_virtual && m_cellHandler)
+    updateRow(index);
+
   return row;
 }
 
+void ListView::updateRow(const int index)
+{
+  const RowPtr &row = m_rows[index];
+
+  for(int ci = 0; ci < columnCount(); ++ci) {
+    Cell cell;
+    m_cellHandler(row.get(), ci, &cell);
+    row->setCell(ci, cell.value, cell.userData);
+  }
+}
+
 void ListView::insertItem(const int viewIndex, const int rowIndex)
 {
   LVITEM item{};
@@ -116,13 +143,24 @@ void ListView::insertItem(const int viewIndex, const int rowIndex)
 void ListView::updateCell(int row, int cell)
 {
   const int viewRowIndex = translate(row);
-  const auto &&text = Win32::widen(m_rows[row]->cell(cell).value);
 
-  ListView_SetItemText(handle(), viewRowIndex, cell,
-    const_cast<Win32::char_type *>(text.c_str()));
+  if(m_virtual) {
+    if(viewRowIndex > -1 && viewRowIndex < visibleRowCount())
+      ListView_RedrawItems(handle(), viewRowIndex, viewRowIndex);
+  }
+  else {
+    const auto &&text = Win32::widen(m_rows[row]->cell(cell).value);
+
+    ListView_SetItemText(handle(), viewRowIndex, cell,
+      const_cast<Win32::char_type *>(text.c_str()));
+  }
+
+  if(m_sort && m_sort->column == cell) {
+    if(row < (int)m_sortKeys.size())
+      m_sortKeys[row].valid = false;
 
-  if(m_sort && m_sort->column == cell)
     m_dirty |= NeedSortFlag;
+  }
 
   m_dirty |= NeedFilterFlag;
 }
@@ -138,6 +176,9 @@ void ListView::enableIcons()
 
 void ListView::setRowIcon(const int row, const int image)
 {
+  if(m_virtual)
+    return; // icons are not stored in virtual mode (unused by virtual lists)
+
   LVITEM item{};
   item.iItem = translate(row);
   item.iImage = image;
@@ -151,6 +192,34 @@ void ListView::removeRow(const int userIndex)
   // translate to view index before fixing lParams
   const int viewIndex = translate(userIndex);
 
+  if(m_virtual) {
+    vector<int> selected = selection(false);
+    selected.erase(remove(selected.begin(), selected.end(), userIndex),
+      selected.end());
+    for(int &index : selected) {
+      if(index > userIndex)
+        --index;
+    }
+
+    m_rows.erase(m_rows.begin() + userIndex);
+    if(userIndex < (int)m_sortKeys.size())
+      m_sortKeys.erase(m_sortKeys.begin() + userIndex);
+    for(int i = userIndex; i < rowCount(); i++)
+      m_rows[i]->userIndex = i;
+
+    if(viewIndex > -1)
+      m_view.erase(m_view.begin() + viewIndex);
+    for(int &index : m_view) {
+      if(index > userIndex)
+        --index;
+    }
+
+    reindexVisible();
+    ListView_SetItemCount(handle(), (int)m_view.size());
+    restoreSelection(selected);
+    return;
+  }
+
   // shift lParam and userIndex of subsequent rows to reflect the new indexes
   const int size = rowCount();
   for(int i = userIndex + 1; i < size; i++) {
@@ -165,6 +234,8 @@ void ListView::removeRow(const int userIndex)
 
   ListView_DeleteItem(handle(), viewIndex);
   m_rows.erase(m_rows.begin() + userIndex);
+  if(userIndex < (int)m_sortKeys.size())
+    m_sortKeys.erase(m_sortKeys.begin() + userIndex);
 
   reindexVisible(); // do it now so further removeRow will work as expected
 }
@@ -181,30 +252,80 @@ int ListView::columnWidth(const int index) const
 
 void ListView::sort()
 {
-  static const auto compare = [](LPARAM aRow, LPARAM bRow, LPARAM param)
-  {
-    const int indexDiff = (int)(aRow - bRow);
+  vector<int> rows;
+
+  if(m_virtual)
+    rows = m_view;
+  else {
+    rows.reserve(visibleRowCount());
+    for(const RowPtr &row : m_rows) {
+      if(row->viewIndex > -1)
+        rows.push_back(row->userIndex);
+    }
+  }
 
-    ListView *view = reinterpret_cast<ListView *>(param);
+  sortRows(&rows);
 
-    if(!view->m_sort)
-      return indexDiff;
+  if(m_virtual) {
+    m_view.swap(rows);
+    InvalidateRect(handle(), nullptr, false);
+  }
+  else {
+    // reorder the native items in one pass using the final positions
+    vector<int> ranks(rowCount());
+    for(int i = 0; i < (int)rows.size(); ++i)
+      ranks[rows[i]] = i;
+
+    static const auto compare = [](LPARAM aRow, LPARAM bRow, LPARAM param)
+    {
+      const vector<int> &ranks = *reinterpret_cast<const vector<int> *>(param);
+      return ranks[aRow] - ranks[bRow];
+    };
+
+    ListView_SortItems(handle(), compare, (LPARAM)&ranks);
+  }
 
-    const int columnIndex = view->m_sort->column;
-    const Column &column = view->m_cols[columnIndex];
+  for(int i = 0; i < (int)rows.size(); ++i)
+    m_rows[rows[i]]->viewIndex = i;
 
-    int ret = column.compare(view->row(aRow)->cell(columnIndex),
-      view->row(bRow)->cell(columnIndex));
+  m_dirty &= ~(NeedSortFlag | NeedReindexFlag);
+}
 
-    if(view->m_sort->order == DescendingOrder)
-      ret = -ret;
+void ListView::sortRows(vector<int> *rows)
+{
+  if(!m_sort) {
+    std::sort(rows->begin(), rows->end());
+    return;
+  }
 
-    return ret ? ret : indexDiff;
-  };
+  const int columnIndex = m_sort->column;
+  const Column &column = m_cols[columnIndex];
+  const bool descending = m_sort->order == DescendingOrder;
 
-  ListView_SortItems(handle(), compare, (LPARAM)this);
+  m_sortKeys.resize(rowCount());
+
+  for(const int ri : *rows) {
+    SortKey &key = m_sortKeys[ri];
+
+    if(key.valid)
+      continue;
+    else if(m_virtual) {
+      Cell cell;
+      m_cellHandler(m_rows[ri].get(), columnIndex, &cell);
+      key = SortKey(column, cell);
+    }
+    else
+      key = SortKey(column, m_rows[ri]->cell(columnIndex));
+  }
 
-  m_dirty = (m_dirty | NeedReindexFlag) & ~NeedSortFlag;
+  std::sort(rows->begin(), rows->end(), [&](const int a, const int b) {
+    int ret = m_sortKeys[a].compare(m_sortKeys[b], column.dataType);
+
+    if(descending)
+      ret = -ret;
+
+    return ret ? ret < 0 : a < b;
+  });
 }
 
 void ListView::sortByColumn(const int index, const SortOrder order, const bool user)
@@ -214,6 +335,9 @@ void ListView::sortByColumn(const int index, const SortOrder order, const bool u
 
   const Sort settings(index, order);
 
+  if(!m_sort || m_sort->column != index)
+    m_sortKeys.clear();
+
   if(!user)
     m_defaultSort = settings;
 
@@ -253,12 +377,33 @@ void ListView::setSortArrow(const bool set)
 
 void ListView::filter()
 {
+  if(m_virtual) {
+    filterVirtual();
+    return;
+  }
+
   vector<int> hide;
 
+  // rows which are not candidates according to the index cannot match,
+  // skip building their filter values entirely
+  vector<size_t> candidates;
+  const bool useIndex = m_filterIndex &&
+    m_filter.candidates(*m_filterIndex, &candidates);
+
+  const auto isMatch = [&](const Row *row) {
+    if(m_filter.empty())
+      return true;
+    else if(useIndex && !binary_search(candidates.begin(), candidates.end(),
+        m_filterDocument(row)))
+      return false;
+
+    return m_filter.match(row->filterValues());
+  };
+
   for(int ri = 0; ri < rowCount(); ++ri) {
     RowPtr &row = m_rows[ri];
 
-    if(m_filter.match(row->filterValues())) {
+    if(isMatch(row.get())) {
       if(row->viewIndex == -1) {
         row->viewIndex = visibleRowCount();
         insertItem(row->viewIndex, ri);
@@ -284,6 +429,55 @@ void ListView::filter()
   m_dirty &= ~NeedFilterFlag;
 }
 
+void ListView::filterVirtual()
+{
+  // the cell handler is only asked for the filter values of the rows that
+  // can match: none when the filter is empty, only the index's candidates
+  // otherwise
+  vector<bool> matches(rowCount(), m_filter.empty());
+
+  if(!m_filter.empty()) {
+    vector<size_t> candidates;
+    const bool useIndex = m_filterIndex &&
+      m_filter.candidates(*m_filterIndex, &candidates);
+
+    for(int ri = 0; ri < rowCount(); ++ri) {
+      const Row *row = m_rows[ri].get();
+
+      if(useIndex && !binary_search(candidates.begin(), candidates.end(),
+          m_filterDocument(row)))
+        continue;
+
+      matches[ri] = m_filter.match(row->filterValues());
+    }
+  }
+
+  // keep the current order of the rows that stay visible
+  vector<int> view;
+  view.reserve(rowCount());
+  for(const int ri : m_view) {
+    if(matches[ri])
+      view.push_back(ri);
+    matches[ri] = false;
+  }
+
+  // newly visible rows are appended and must be sorted into place
+  for(int ri = 0; ri < rowCount(); ++ri) {
+    if(matches[ri]) {
+      view.push_back(ri);
+      m_dirty |= NeedSortFlag;
+    }
+  }
+
+  for(const int ri : m_view)
+    m_rows[ri]->viewIndex = -1;
+
+  m_view.swap(view);
+  ListView_SetItemCount(handle(), (int)m_view.size());
+
+  m_dirty = (m_dirty | NeedReindexFlag) & ~NeedFilterFlag;
+}
+
 void ListView::setFilter(const string &newFilter)
 {
   if(m_filter != newFilter) {
@@ -293,8 +487,27 @@ void ListView::setFilter(const string &newFilter)
   }
 }
 
+void ListView::setFilterIndex(const TrigramIndex *index,
+  const DocumentHandler &handler)
+{
+  // The index must cover the values of every column having FilterFlag.
+  // It is only used to pre-select candidates, every row is still verified.
+  ListView::BeginEdit edit(this);
+  m_filterIndex = index;
+  m_filterDocument = handler;
+  m_dirty |= NeedFilterFlag;
+}
+
 void ListView::reindexVisible()
 {
+  if(m_virtual) {
+    for(int viewIndex = 0; viewIndex < (int)m_view.size(); viewIndex++)
+      m_rows[m_view[viewIndex]]->viewIndex = viewIndex;
+
+    m_dirty &= ~NeedReindexFlag;
+    return;
+  }
+
   const int visibleCount = visibleRowCount();
   for(int viewIndex = 0; viewIndex < visibleCount; viewIndex++) {
     LVITEM item{};
@@ -310,6 +523,16 @@ void ListView::reindexVisible()
 
 void ListView::endEdit()
 {
+  // the selection of virtual lists is kept by view index
+  const bool keepSelection = m_virtual &&
+    (m_dirty & (NeedFilterFlag | NeedSortFlag)) != 0;
+
+  vector<int> selected, oldView;
+  if(keepSelection) {
+    selected = selection(false);
+    oldView = m_view;
+  }
+
   if(m_dirty & NeedFilterFlag)
     filter(); // filter may set NeedSortFlag
   if(m_dirty & NeedSortFlag)
@@ -317,14 +540,31 @@ void ListView::endEdit()
   if(m_dirty & NeedReindexFlag)
     reindexVisible();
 
+  if(keepSelection && m_view != oldView)
+    restoreSelection(selected);
+
   assert(!m_dirty);
 }
 
+void ListView::restoreSelection(const vector<int> &selected)
+{
+  unselectAll();
+
+  for(const int index : selected)
+    select(index);
+}
+
 void ListView::clear()
 {
   ListView_DeleteAllItems(handle());
 
+  if(m_virtual) {
+    ListView_SetItemCount(handle(), 0);
+    m_view.clear();
+  }
+
   m_rows.clear();
+  m_sortKeys.clear();
 }
 
 void ListView::reset()
@@ -339,16 +579,23 @@ void ListView::reset()
   m_customizable = false;
   m_sort = boost::none;
   m_defaultSort = boost::none;
+  m_sortKeys.clear();
 }
 
 void ListView::setSelected(const int index, const bool select)
 {
+  if(index > -1 && row(index)->viewIndex < 0)
+    return; // hidden by the filter
+
   ListView_SetItemState(handle(), translate(index),
     select ? LVIS_SELECTED : 0, LVIS_SELECTED);
 }
 
 int ListView::visibleRowCount() const
 {
+  if(m_virtual)
+    return (int)m_view.size();
+
   return ListView_GetItemCount(handle());
 }
 
@@ -437,6 +684,9 @@ void ListView::onNotify(LPNMHDR info, LPARAM lParam)
   case LVN_COLUMNCLICK:
     onColumnClick(lParam);
     break;
+  case LVN_GETDISPINFO:
+    onGetDispInfo(lParam);
+    break;
   };
 }
 
@@ -509,6 +759,29 @@ void ListView::onItemChanged(const LPARAM lParam)
     m_onSelect();
 }
 
+void ListView::onGetDispInfo(const LPARAM lParam)
+{
+  const auto info = reinterpret_cast<NMLVDISPINFO *>(lParam);
+  LVITEM &item = info->item;
+
+  if(!m_virtual || !(item.mask & LVIF_TEXT) || item.cchTextMax < 1)
+    return;
+
+  const int index = translateBack(item.iItem);
+  if(index < 0) {
+    item.pszText[0] = 0;
+    return;
+  }
+
+  Cell cell;
+  m_cellHandler(m_rows[index].get(), item.iSubItem, &cell);
+
+  const auto &&text = Win32::widen(cell.value);
+  const size_t length = min(text.size(), (size_t)item.cchTextMax - 1);
+  copy(text.begin(), text.begin() + length, item.pszText);
+  item.pszText[length] = 0;
+}
+
 void ListView::onClick(const bool dbclick)
 {
   bool overIcon;
@@ -544,7 +817,9 @@ void ListView::onColumnClick(const LPARAM lParam)
 
 int ListView::translate(const int userIndex) const
 {
-  if(!m_sort || userIndex < 0)
+  if(m_virtual && userIndex > -1)
+    return row(userIndex)->viewIndex;
+  else if(!m_sort || userIndex < 0)
     return userIndex;
   else
     return row(userIndex)->viewIndex;
@@ -552,7 +827,9 @@ int ListView::translate(const int userIndex) const
 
 int ListView::translateBack(const int internalIndex) const
 {
-  if(!m_sort || internalIndex < 0)
+  if(m_virtual && internalIndex > -1)
+    return internalIndex < (int)m_view.size() ? m_view[internalIndex] : -1;
+  else if(!m_sort || internalIndex < 0)
     return internalIndex;
 
   LVITEM item{};
@@ -607,6 +884,7 @@ void ListView::resetColumns()
   if(m_sort) {
     setSortArrow(false);
     m_sort = m_defaultSort;
+    m_sortKeys.clear();
     setSortArrow(true);
 
     m_dirty |= NeedSortFlag;
@@ -668,46 +946,81 @@ void ListView::saveState(Serializer::Data &data) const
     data.push_back({order[i], columnWidth(i)});
 }
 
-int ListView::Column::compare(const ListView::Cell &cl, const ListView::Cell &cr) const
+// Only needed to compare a packed version with one that couldn't be packed
+// (prereleases or more than four segments).
+static VersionName unpackVersion(const uint64_t number)
 {
-  if(dataType) {
-    if(!cl.userData)
-      return -1;
-    else if(!cr.userData)
-      return 1;
-  }
-
-  switch(dataType) {
-  case UserType: { // arbitrary data or no data: sort by visible text
-    string l = cl.value, r = cr.value;
+  char name[32];
+  snprintf(name, sizeof(name), "%u.%u.%u.%u",
+    (unsigned int)(number >> 48 & 0xffff), (unsigned int)(number >> 32 & 0xffff),
+    (unsigned int)(number >> 16 & 0xffff), (unsigned int)(number & 0xffff));
 
-    boost::algorithm::to_lower(l);
-    boost::algorithm::to_lower(r);
+  return VersionName(name);
+}
 
-    return l.compare(r);
-  }
+ListView::SortKey::SortKey(const Column &column, const Cell &cell)
+  : valid(true), null(!cell.userData), packed(false), number(0)
+{
+  switch(column.dataType) {
+  case UserType: // arbitrary data or no data: sort by visible text
+    null = false;
+    text = boost::algorithm::to_lower_copy(cell.value);
+    break;
   case VersionType:
-    return static_cast<const VersionName *>(cl.userData)->compare(
-      *static_cast<const VersionName *>(cr.userData));
+    if(!null) {
+      const auto *name = static_cast<const VersionName *>(cell.userData);
+      packed = name->packed(&number);
+
+      // copied only when it can't be compared by number
+      if(!packed)
+        version = make_shared<VersionName>(*name);
+    }
+    break;
   case TimeType:
-    return static_cast<const Time *>(cl.userData)->compare(
-      *static_cast<const Time *>(cr.userData));
+    if(!null) {
+      packed = true;
+      number = static_cast<uint64_t>(
+        static_cast<const Time *>(cell.userData)->packed());
+    }
+    break;
   }
+}
 
-  return 0; // to make MSVC happy
+int ListView::SortKey::compare(const SortKey &o, const ColumnDataType type) const
+{
+  if(type == UserType)
+    return text.compare(o.text);
+  else if(null || o.null)
+    return o.null - null;
+  else if(packed && o.packed)
+    return number < o.number ? -1 : number > o.number;
+  else if(packed)
+    return unpackVersion(number).compare(*o.version);
+  else if(o.packed)
+    return version->compare(unpackVersion(o.number));
+  else
+    return version->compare(*o.version);
 }
 
 ListView::Row::Row(void *data, ListView *list)
   : userData(data), viewIndex(list->rowCount()), userIndex(viewIndex),
-  m_list(list), m_cells(new Cell[m_list->columnCount()])
+  m_list(list), m_cells(list->m_virtual ? nullptr : new Cell[list->columnCount()])
 {
 }
 
+const ListView::Cell &ListView::Row::cell(const int i) const
+{
+  assert(m_cells);
+  return m_cells[i];
+}
+
 void ListView::Row::setCell(const int i, const string &val, void *data)
 {
-  Cell &cell = m_cells[i];
-  cell.value = val;
-  cell.userData = data;
+  if(m_cells) {
+    Cell &cell = m_cells[i];
+    cell.value = val;
+    cell.userData = data;
+  }
 
   m_list->updateCell(userIndex, i);
 }
@@ -722,8 +1035,15 @@ vector<string> ListView::Row::filterValues() const
   vector<string> values;
 
   for(int ci = 0; ci < m_list->columnCount(); ++ci) {
-    if(m_list->column(ci).test(FilterFlag))
+    if(!m_list->column(ci).test(FilterFlag))
+      continue;
+    else if(m_cells)
       values.push_back(m_cells[ci].value);
+    else {
+      Cell cell;
+      m_list->m_cellHandler(this, ci, &cell);
+      values.push_back(move(cell.value));
+    }
   }
 
   return values;
@@ -26,9 +26,12 @@
 #include <boost/optional.hpp>
 #include <boost/signals2.hpp>
 #include <functional>
+#include <memory>
 #include <vector>
 
 class Menu;
+class TrigramIndex;
+class VersionName;
 
 class ListView : public Control {
 public:
@@ -64,7 +67,10 @@ public:
 
     int index() const { return userIndex; }
 
-    const Cell &cell(const int i) const { return m_cells[i]; }
+    // Not available in virtual mode, ask the cell handler instead.
+    const Cell &cell(int i) const;
+    // In virtual mode the value is not stored: the cell is only redrawn
+    // using the value given by the cell handler.
     void setCell(const int i, const std::string &, void *data = nullptr);
     void setChecked(bool check = true);
 
@@ -89,7 +95,6 @@ public:
     ColumnDataType dataType;
 
     bool test(ColumnFlag f) const { return (flags & f) != 0; }
-    int compare(const Cell &, const Cell &) const;
   };
 
   // Use before modifying the list's content. It will re-sort and/or re-filter the
@@ -108,12 +113,21 @@ public:
 
   typedef boost::signals2::signal<void ()> VoidSignal;
   typedef boost::signals2::signal<bool (Menu &, int index)> MenuSignal;
+  typedef std::function<size_t (const Row *)> DocumentHandler;
+  typedef std::function<void (const Row *, int column, Cell *)> CellHandler;
 
+  // Lists created with the LVS_OWNERDATA style work in virtual mode: rows don't
+  // hold their cells and the contents of the visible rows are requested from
+  // the cell handler only when they are painted.
   ListView(HWND handle, const Columns & = {});
 
+  bool isVirtual() const { return m_virtual; }
+  void setCellHandler(const CellHandler &cb) { m_cellHandler = cb; }
+
   void reserveRows(size_t count) { m_rows.reserve(count); }
   RowPtr createRow(void *data = nullptr);
   const RowPtr &row(size_t index) const { return m_rows[index]; }
+  void updateRow(int index); // reload the cells from the cell handler
   void removeRow(int index);
   int rowCount() const { return (int)m_rows.size(); }
   int visibleRowCount() const;
@@ -147,6 +161,7 @@ public:
 
   void sortByColumn(int index, SortOrder order = AscendingOrder, bool user = false);
   void setFilter(const std::string &);
+  void setFilterIndex(const TrigramIndex *, const DocumentHandler &);
   void endEdit();
 
   void restoreState(Serializer::Data &);
@@ -173,6 +188,22 @@ private:
     SortOrder order;
   };
 
+  // computed once per row for the sorted column, it doesn't reference
+  // the cell's user data so that it stays valid if the data is replaced
+  struct SortKey {
+    SortKey() : valid(false), null(true), packed(false), number(0) {}
+    SortKey(const Column &, const Cell &);
+
+    int compare(const SortKey &, ColumnDataType) const;
+
+    bool valid;
+    bool null;
+    bool packed;
+    uint64_t number;
+    std::string text;
+    std::shared_ptr<const VersionName> version;
+  };
+
   enum DirtyFlag {
     NeedSortFlag    = 1<<0,
     NeedReindexFlag = 1<<1,
@@ -185,6 +216,7 @@ private:
   void setExStyle(int style, bool enable = true);
   void setSortArrow(bool);
   void onItemChanged(LPARAM lpnmlistview);
+  void onGetDispInfo(LPARAM lpnmlvdispinfo);
   void onClick(bool dbclick);
   void onColumnClick(LPARAM lpnmlistview);
   int translate(int userIndex) const;
@@ -192,17 +224,26 @@ private:
   void headerMenu(int x, int y);
   void insertItem(int viewIndex, int rowIndex);
   void sort();
+  void sortRows(std::vector<int> *);
   void reindexVisible();
   void filter();
+  void filterVirtual();
+  void restoreSelection(const std::vector<int> &);
 
+  bool m_virtual;
   int m_dirty;
   Filter m_filter;
+  const TrigramIndex *m_filterIndex;
+  DocumentHandler m_filterDocument;
 
   bool m_customizable;
   std::vector<Column> m_cols;
   std::vector<RowPtr> m_rows;
+  std::vector<int> m_view; // visible rows in virtual mode
+  CellHandler m_cellHandler;
   boost::optional<Sort> m_sort;
   boost::optional<Sort> m_defaultSort;
+  std::vector<SortKey> m_sortKeys;
 
   VoidSignal m_onSelect;
   VoidSignal m_onIconClick;
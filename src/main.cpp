@@ -146,6 +146,9 @@ static void setupActions()
   g_reapack->setupAction("REAPACK_MANAGE", "ReaPack: Manage repositories...",
     &g_reapack->configAction, bind(&ReaPack::manageRemotes, g_reapack));
 
+  g_reapack->setupAction("REAPACK_TRACE", "ReaPack: Save performance trace",
+    &g_reapack->traceAction, bind(&ReaPack::saveTrace, g_reapack));
+
   g_reapack->setupAction("REAPACK_ABOUT", bind(&ReaPack::aboutSelf, g_reapack));
 }
 
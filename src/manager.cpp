@@ -44,7 +44,7 @@ enum {
   ACTION_AUTOINSTALL_OFF, ACTION_AUTOINSTALL_ON, ACTION_AUTOINSTALL,
   ACTION_BLEEDINGEDGE, ACTION_PROMPTOBSOLETE, ACTION_NETCONFIG,
   ACTION_RESETCONFIG, ACTION_IMPORT_REPO, ACTION_IMPORT_ARCHIVE,
-  ACTION_EXPORT_ARCHIVE,
+  ACTION_EXPORT_ARCHIVE, ACTION_EXPORT_INCREMENTAL,
 };
 
 enum { TIMER_ABOUT = 1, };
@@ -149,7 +149,10 @@ void Manager::onCommand(const int id, int)
     importArchive();
     break;
   case ACTION_EXPORT_ARCHIVE:
-    exportArchive();
+    exportArchive(false);
+    break;
+  case ACTION_EXPORT_INCREMENTAL:
+    exportArchive(true);
     break;
   case ACTION_AUTOINSTALL:
     toggle(m_autoInstall, g_reapack->config()->install.autoInstall);
@@ -472,6 +475,7 @@ void Manager::importExport()
   menu.addSeparator();
   menu.addAction("Import offline archive...", ACTION_IMPORT_ARCHIVE);
   menu.addAction("&Export offline archive...", ACTION_EXPORT_ARCHIVE);
+  menu.addAction("Export &incremental archive...", ACTION_EXPORT_INCREMENTAL);
 
   menu.show(getControl(IDC_IMPORT), handle());
 }
@@ -509,14 +513,25 @@ void Manager::importArchive()
   }
 }
 
-void Manager::exportArchive()
+void Manager::exportArchive(const bool incremental)
 {
+  string base;
+
+  if(incremental) {
+    base = FileDialog::getOpenFileName(handle(), instance(),
+      "Select the previous archive", Path::DATA.prependRoot(),
+      ARCHIVE_FILTER, ARCHIVE_EXT);
+
+    if(base.empty())
+      return;
+  }
+
   const string &path = FileDialog::getSaveFileName(handle(), instance(),
     "Export offline archive", Path::DATA.prependRoot(), ARCHIVE_FILTER, ARCHIVE_EXT);
 
   if(!path.empty()) {
     if(Transaction *tx = g_reapack->setupTransaction()) {
-      tx->exportArchive(path);
+      tx->exportArchive(path, base);
       tx->runTasks();
     }
   }
@@ -70,7 +70,7 @@ private:
   void options();
   void setupNetwork();
   void importArchive();
-  void exportArchive();
+  void exportArchive(bool incremental);
   void aboutRepo(bool focus = true);
 
   void setChange(int);
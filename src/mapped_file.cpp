@@ -0,0 +1,117 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mapped_file.hpp"
+
+#include "path.hpp"
+#include "win32.hpp"
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+static size_t pageSize()
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwPageSize;
+#else
+  return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+MappedFile::MappedFile(const Path &path)
+  : m_open(false), m_data(""), m_size(0)
+{
+  const auto &&fullPath = Win32::widen(path.prependRoot().join());
+
+#ifdef _WIN32
+  const HANDLE file = CreateFile(fullPath.c_str(), GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+  if(file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER size;
+  if(!GetFileSizeEx(file, &size))
+    size.QuadPart = -1;
+
+  if(size.QuadPart > 0) {
+    if(HANDLE mapping = CreateFileMapping(file, nullptr,
+        PAGE_READONLY, 0, 0, nullptr)) {
+      if(void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) {
+        m_data = static_cast<const char *>(view);
+        m_size = (size_t)size.QuadPart;
+        m_open = true;
+      }
+
+      CloseHandle(mapping); // the view keeps the mapping alive
+    }
+  }
+  else
+    m_open = size.QuadPart == 0; // empty file
+
+  CloseHandle(file);
+#else
+  const int fd = open(fullPath.c_str(), O_RDONLY);
+  if(fd < 0)
+    return;
+
+  struct stat st;
+  if(fstat(fd, &st))
+    st.st_size = -1;
+
+  if(st.st_size > 0) {
+    void *addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(addr != MAP_FAILED) {
+      m_data = static_cast<const char *>(addr);
+      m_size = (size_t)st.st_size;
+      m_open = true;
+    }
+  }
+  else
+    m_open = st.st_size == 0; // empty file
+
+  close(fd); // the mapping stays valid
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+  if(!m_size)
+    return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(m_data);
+#else
+  munmap(const_cast<char *>(m_data), m_size);
+#endif
+}
+
+bool MappedFile::isTerminated() const
+{
+  return !m_size || m_size % pageSize() != 0;
+}
@@ -0,0 +1,47 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAPACK_MAPPED_FILE_HPP
+#define REAPACK_MAPPED_FILE_HPP
+
+#include <cstddef>
+
+class Path;
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+public:
+  MappedFile(const Path &);
+  MappedFile(const MappedFile &) = delete;
+  ~MappedFile();
+
+  bool isOpen() const { return m_open; }
+  const char *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+  // Whether a null byte follows the data. The rest of the last page of a
+  // mapping is filled with zeros, unless the file ends on a page boundary.
+  bool isTerminated() const;
+
+private:
+  bool m_open;
+  const char *m_data;
+  size_t m_size;
+};
+
+#endif
@@ -17,6 +17,7 @@
 
 #include "progress.hpp"
 
+#include "download.hpp"
 #include "thread.hpp"
 #include "resource.hpp"
 #include "win32.hpp"
@@ -25,10 +26,12 @@
 
 using namespace std;
 
+enum Timers { TIMER_SHOW = 1, TIMER_SPEED };
+
 Progress::Progress(ThreadPool *pool)
   : Dialog(IDD_PROGRESS_DIALOG),
     m_pool(pool), m_label(nullptr), m_progress(nullptr),
-    m_done(0), m_total(0)
+    m_done(0), m_total(0), m_received(0), m_speed(0)
 {
   m_pool->onPush(bind(&Progress::addTask, this, _1));
 }
@@ -41,6 +44,9 @@ void Progress::onInit()
   m_progress = getControl(IDC_PROGRESS);
 
   Win32::setWindowText(m_label, "Initializing...");
+
+  m_received = Download::totalReceived();
+  startTimer(1000, TIMER_SPEED);
 }
 
 void Progress::onCommand(const int id, int)
@@ -58,13 +64,20 @@ void Progress::onCommand(const int id, int)
 
 void Progress::onTimer(const int id)
 {
+  switch(id) {
+  case TIMER_SHOW:
 #ifdef _WIN32
-  if(!IsWindowEnabled(handle()))
-    return;
+    if(!IsWindowEnabled(handle()))
+      return;
 #endif
 
-  show();
-  stopTimer(id);
+    show();
+    stopTimer(id);
+    break;
+  case TIMER_SPEED:
+    updateSpeed();
+    break;
+  }
 }
 
 void Progress::addTask(ThreadTask *task)
@@ -73,7 +86,7 @@ void Progress::addTask(ThreadTask *task)
   updateProgress();
 
   if(!isVisible())
-    startTimer(100);
+    startTimer(100, TIMER_SHOW);
 
   task->onStart([=] {
     m_current = task->summary();
@@ -101,9 +114,24 @@ void Progress::updateProgress()
   const int percent = (int)(pos * 100);
 
   char title[255];
-  snprintf(title, sizeof(title),
+  const int len = snprintf(title, sizeof(title),
     "ReaPack: Operation in progress (%d%%)", percent);
 
+  if(m_speed > 0) {
+    snprintf(title + len, sizeof(title) - len, " - %s/s",
+      String::formatSize(m_speed).c_str());
+  }
+
   SendMessage(m_progress, PBM_SETPOS, percent, 0);
   Win32::setWindowText(handle(), title);
 }
+
+void Progress::updateSpeed()
+{
+  // sampled once per second, so the byte delta is the rate
+  const int64_t received = Download::totalReceived();
+  m_speed = received - m_received;
+  m_received = received;
+
+  updateProgress();
+}
@@ -35,6 +35,7 @@ protected:
 private:
   void addTask(ThreadTask *);
   void updateProgress();
+  void updateSpeed();
 
   ThreadPool *m_pool;
   std::string m_current;
@@ -44,6 +45,9 @@ private:
 
   int m_done;
   int m_total;
+
+  int64_t m_received;
+  int64_t m_speed;
 };
 
 #endif
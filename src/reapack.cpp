@@ -30,6 +30,7 @@
 #include "progress.hpp"
 #include "report.hpp"
 #include "richedit.hpp"
+#include "trace.hpp"
 #include "transaction.hpp"
 #include "win32.hpp"
 
@@ -80,8 +81,9 @@ Path ReaPack::resourcePath()
 
 ReaPack::ReaPack(REAPER_PLUGIN_HINSTANCE instance)
   : syncAction(), browseAction(), importAction(), configAction(),
-    m_tx(nullptr), m_progress(nullptr), m_browser(nullptr), m_manager(nullptr),
-    m_about(nullptr), m_instance(instance), m_useRootPath(resourcePath())
+    traceAction(), m_tx(nullptr), m_progress(nullptr), m_browser(nullptr),
+    m_manager(nullptr), m_about(nullptr), m_instance(instance),
+    m_useRootPath(resourcePath())
 {
   assert(!s_instance);
   s_instance = this;
@@ -255,6 +257,24 @@ void ReaPack::aboutSelf()
   about(remote("ReaPack"));
 }
 
+void ReaPack::saveTrace()
+{
+  const Path path = Path::DATA + "trace.json";
+  char msg[512];
+
+  if(Trace::save(path)) {
+    snprintf(msg, sizeof(msg), "The performance trace was saved to %s.\n\n"
+      "It can be opened in chrome://tracing or ui.perfetto.dev.",
+      path.prependRoot().join().c_str());
+  }
+  else {
+    snprintf(msg, sizeof(msg), "Could not save the performance trace to %s: %s",
+      path.prependRoot().join().c_str(), FS::lastError());
+  }
+
+  Win32::messageBox(m_mainWindow, msg, "ReaPack", MB_OK);
+}
+
 About *ReaPack::about(const bool instantiate)
 {
   if(m_about)
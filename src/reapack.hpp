@@ -53,6 +53,7 @@ public:
   gaccel_register_t browseAction;
   gaccel_register_t importAction;
   gaccel_register_t configAction;
+  gaccel_register_t traceAction;
 
   ReaPack(REAPER_PLUGIN_HINSTANCE);
   ~ReaPack();
@@ -70,6 +71,7 @@ public:
   void importRemote();
   void manageRemotes();
   void aboutSelf();
+  void saveTrace();
   void about(const Remote &, bool focus = true);
   About *about(bool instantiate = true);
   Browser *browsePackages();
@@ -18,8 +18,10 @@
 #include "receipt.hpp"
 
 #include "index.hpp"
+#include "string.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <algorithm>
 #include <boost/range/adaptor/reversed.hpp>
 #include <sstream>
 
@@ -66,6 +68,12 @@ void Receipt::addError(const ErrorInfo &err)
   m_flags |= ErrorFlag;
 }
 
+void Receipt::addDownload(const DownloadStats &stats)
+{
+  // not worth showing the report on its own
+  m_downloads.push_back(stats);
+}
+
 ReceiptPage Receipt::installedPage() const
 {
   return {m_installs, "Installed"};
@@ -86,6 +94,18 @@ ReceiptPage Receipt::errorPage() const
   return {m_errors, "Error", "Errors"};
 }
 
+ReceiptPage Receipt::downloadsPage() const
+{
+  // slowest first
+  vector<DownloadStats> downloads = m_downloads;
+  stable_sort(downloads.begin(), downloads.end(),
+    [](const DownloadStats &l, const DownloadStats &r) {
+      return l.total > r.total;
+    });
+
+  return {downloads, "Download", "Downloads"};
+}
+
 void ReceiptPage::setTitle(const char *title)
 {
   ostringstream stream;
@@ -137,3 +157,21 @@ ostream &operator<<(ostream &os, const InstallTicket &t)
 
   return os;
 }
+
+ostream &operator<<(ostream &os, const DownloadStats &stats)
+{
+  const auto ms = [](const double seconds) {
+    return (int)(seconds * 1000 + 0.5);
+  };
+  const double speed = stats.total > 0 ? stats.size / stats.total : 0;
+
+  os << stats.url << "\r\n" << String::indent(String::format(
+    "%s in %d ms (%s/s)\n"
+    "name lookup %d ms, connect %d ms, TLS %d ms, first byte %d ms",
+    String::formatSize(stats.size).c_str(), ms(stats.total),
+    String::formatSize((int64_t)speed).c_str(), ms(stats.nameLookup),
+    ms(stats.connect), ms(stats.tlsHandshake), ms(stats.firstByte)
+  )) << "\r\n";
+
+  return os;
+}
@@ -34,6 +34,19 @@ class Version;
 
 typedef std::shared_ptr<const Index> IndexPtr;
 
+struct DownloadStats {
+  std::string url;
+  int64_t size;
+  // in seconds since the start of the transfer
+  double nameLookup;
+  double connect;
+  double tlsHandshake;
+  double firstByte;
+  double total;
+};
+
+std::ostream &operator<<(std::ostream &, const DownloadStats &);
+
 class Receipt {
 public:
   enum Flag {
@@ -62,11 +75,13 @@ public:
   void addRemoval(const Path &p);
   void addExport(const Path &p);
   void addError(const ErrorInfo &);
+  void addDownload(const DownloadStats &);
 
   ReceiptPage installedPage() const;
   ReceiptPage removedPage() const;
   ReceiptPage exportedPage() const;
   ReceiptPage errorPage() const;
+  ReceiptPage downloadsPage() const;
 
 private:
   int m_flags;
@@ -75,6 +90,7 @@ private:
   std::set<Path> m_removals;
   std::set<Path> m_exports;
   std::vector<ErrorInfo> m_errors;
+  std::vector<DownloadStats> m_downloads;
 };
 
 class ReceiptPage {
@@ -18,10 +18,12 @@
 #include "registry.hpp"
 
 #include "errors.hpp"
+#include "filesystem.hpp"
 #include "index.hpp"
 #include "package.hpp"
 #include "path.hpp"
 #include "remote.hpp"
+#include "trace.hpp"
 
 #include <algorithm>
 
@@ -64,9 +66,15 @@ Registry::Registry(const Path &path)
     "FROM entries e JOIN files f ON f.entry = e.id WHERE f.path = ? LIMIT 1"
   );
   m_getFiles = m_db.prepare(
-    "SELECT path, main, type FROM files WHERE entry = ? ORDER BY path"
+    "SELECT path, main, type, size, mtime, hash FROM files "
+    "WHERE entry = ? ORDER BY path"
+  );
+  m_insertFile = m_db.prepare(
+    "INSERT INTO files(entry, path, main, type) VALUES(?, ?, ?, ?)"
+  );
+  m_setFileState = m_db.prepare(
+    "UPDATE files SET size = ?, mtime = ?, hash = ? WHERE path = ?"
   );
-  m_insertFile = m_db.prepare("INSERT INTO files VALUES(NULL, ?, ?, ?, ?)");
   m_clearFiles = m_db.prepare(
     "DELETE FROM files WHERE entry = ("
     "  SELECT id FROM entries WHERE remote = ? AND category = ? AND package = ?"
@@ -80,7 +88,7 @@ Registry::Registry(const Path &path)
 
 void Registry::migrate()
 {
-  const Database::Version version{0, 5};
+  const Database::Version version{0, 6};
   const Database::Version &current = m_db.version();
 
   if(!current) {
@@ -105,6 +113,9 @@ void Registry::migrate()
       "  path TEXT UNIQUE NOT NULL,"
       "  main INTEGER NOT NULL,"
       "  type INTEGER NOT NULL,"
+      "  size INTEGER NOT NULL DEFAULT 0,"
+      "  mtime INTEGER NOT NULL DEFAULT 0,"
+      "  hash TEXT NOT NULL DEFAULT '',"
       "  FOREIGN KEY(entry) REFERENCES entries(id)"
       ");"
     );
@@ -137,6 +148,13 @@ void Registry::migrate()
       // FALLTHROUGH
     case 4:
       convertImplicitSections();
+      // FALLTHROUGH
+    case 5:
+      m_db.exec(
+        "ALTER TABLE files ADD COLUMN size INTEGER NOT NULL DEFAULT 0;"
+        "ALTER TABLE files ADD COLUMN mtime INTEGER NOT NULL DEFAULT 0;"
+        "ALTER TABLE files ADD COLUMN hash TEXT NOT NULL DEFAULT '';"
+      );
     }
 
     m_db.setVersion(version);
@@ -146,6 +164,7 @@ void Registry::migrate()
 
 auto Registry::push(const Version *ver, vector<Path> *conflicts) -> Entry
 {
+  Trace::Span span("Registry::push", ver->fullName());
   m_db.savepoint();
 
   bool hasConflicts = false;
@@ -225,6 +244,24 @@ void Registry::setPinned(const Entry &entry, const bool pinned)
   m_setPinned->exec();
 }
 
+bool Registry::File::isUnchanged() const
+{
+  int64_t currentSize;
+  time_t currentMtime;
+
+  return mtime && FS::size(path, &currentSize) && currentSize == size &&
+    FS::mtime(path, &currentMtime) && currentMtime == mtime;
+}
+
+void Registry::setFileState(const File &file)
+{
+  m_setFileState->bind(1, file.size);
+  m_setFileState->bind(2, file.mtime);
+  m_setFileState->bind(3, file.hash);
+  m_setFileState->bind(4, file.path.join(false));
+  m_setFileState->exec();
+}
+
 auto Registry::getEntry(const Package *pkg) const -> Entry
 {
   Entry entry{};
@@ -275,6 +312,9 @@ auto Registry::getFiles(const Entry &entry) const -> vector<File>
       m_getFiles->stringColumn(col++),
       static_cast<int>(m_getFiles->intColumn(col++)),
       static_cast<Package::Type>(m_getFiles->intColumn(col++)),
+      m_getFiles->intColumn(col++),
+      static_cast<time_t>(m_getFiles->intColumn(col++)),
+      m_getFiles->stringColumn(col++),
     };
 
     if(!file.type) // < v1.0rc2
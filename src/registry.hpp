@@ -50,6 +50,14 @@ public:
     int sections;
     Package::Type type;
 
+    // state of the installed file, used to skip unchanged files on reinstall
+    int64_t size;
+    time_t mtime;
+    std::string hash;
+
+    // whether the file on disk still has the recorded size and mtime
+    bool isUnchanged() const;
+
     bool operator<(const File &o) const { return path < o.path; }
   };
 
@@ -62,6 +70,7 @@ public:
   std::vector<File> getMainFiles(const Entry &) const;
   Entry push(const Version *, std::vector<Path> *conflicts = nullptr);
   void setPinned(const Entry &, bool pinned);
+  void setFileState(const File &);
   void forget(const Entry &);
 
   void savepoint() { m_db.savepoint(); }
@@ -84,6 +93,7 @@ private:
 
   Statement *m_getFiles;
   Statement *m_insertFile;
+  Statement *m_setFileState;
   Statement *m_clearFiles;
   Statement *m_forgetFiles;
 };
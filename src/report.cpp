@@ -43,6 +43,7 @@ void Report::onInit()
     m_receipt->removedPage(),
     m_receipt->exportedPage(),
     m_receipt->errorPage(),
+    m_receipt->downloadsPage(),
   };
 
   for(const auto &page : pages)
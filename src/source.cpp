@@ -63,6 +63,15 @@ Source::Source(const string &file, const string &url, const Version *ver)
     throw reapack_error("empty source url");
 }
 
+void Source::setChecksum(const string &checksum)
+{
+  if(checksum.size() != 64 || checksum.find_first_not_of(
+      "0123456789abcdefABCDEF") != string::npos)
+    throw reapack_error("invalid source hash");
+
+  m_checksum = boost::algorithm::to_lower_copy(checksum);
+}
+
 Package::Type Source::type() const
 {
   if(m_type)
@@ -51,6 +51,8 @@ public:
   Package::Type type() const;
   const std::string &file() const;
   const std::string &url() const { return m_url; }
+  void setChecksum(const std::string &); // hexadecimal SHA-256
+  const std::string &checksum() const { return m_checksum; }
   void setSections(int);
   int sections() const { return m_sections; }
 
@@ -61,6 +63,7 @@ private:
   Package::Type m_type;
   std::string m_file;
   std::string m_url;
+  std::string m_checksum;
   int m_sections;
   Path m_targetPath;
   const Version *m_version;
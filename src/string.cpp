@@ -65,6 +65,24 @@ string String::indent(const string &text)
   return output;
 }
 
+string String::formatSize(const int64_t bytes)
+{
+  static const char *units[] = {"KB", "MB", "GB", "TB"};
+
+  if(bytes < 1024)
+    return format("%d B", (int)bytes);
+
+  double size = bytes / 1024.0;
+  size_t unit = 0;
+
+  while(size >= 1024 && unit + 1 < sizeof(units) / sizeof(*units)) {
+    size /= 1024;
+    ++unit;
+  }
+
+  return format("%.1f %s", size, units[unit]);
+}
+
 void String::imbueStream(ostream &stream)
 {
   class NumPunct : public std::numpunct<char>
@@ -18,6 +18,7 @@
 #ifndef REAPACK_STRING_HPP
 #define REAPACK_STRING_HPP
 
+#include <cstdint>
 #include <string>
 
 namespace String {
@@ -27,6 +28,7 @@ namespace String {
   std::string format(const char *fmt, ...);
 
   std::string indent(const std::string &);
+  std::string formatSize(int64_t bytes);
 
   void imbueStream(std::ostream &);
 }
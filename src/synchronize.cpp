@@ -19,14 +19,120 @@
 
 #include "config.hpp"
 #include "download.hpp"
+#include "errors.hpp"
 #include "filesystem.hpp"
+#include "gzip.hpp"
+#include "hash.hpp"
 #include "index.hpp"
+#include "index_delta.hpp"
+#include "mapped_file.hpp"
 #include "reapack.hpp"
 #include "transaction.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <limits>
+
+using namespace std;
+
+// remotes without a pre-compressed index.xml.gz, remembered for the session
+static set<string> g_noCompressedIndex;
+
+// decompress the cached copy straight from the mapping, without reading
+// the compressed data into a buffer first
+static bool readIndex(const Path &path, string *contents)
+{
+  const MappedFile file(path);
+  if(!file.isOpen())
+    return false;
+
+  if(Gzip::isCompressed(file.data(), file.size()))
+    return Gzip::decompress(file.data(), file.size(), contents);
+
+  contents->assign(file.data(), file.size());
+  return true;
+}
+
+// Stores the index in the worker thread: deltas are applied to the cached
+// copy and the result is written back compressed. Full compressed indexes
+// are stored as-is. The hash of the uncompressed index is the base of the
+// next delta.
+class IndexDownload : public FileDownload {
+public:
+  IndexDownload(const Path &target, const string &url,
+      const string &baseHash, const bool compressed, const int flags)
+    : FileDownload(target, url, g_reapack->config()->network, flags),
+      m_baseHash(baseHash), m_compressed(compressed), m_invalid(false)
+  {}
+
+  const string &indexHash() const { return m_indexHash; }
+  // the transfer succeeded but the data could not be stored
+  bool isInvalid() const { return m_invalid; }
+
+protected:
+  bool finishStream() override
+  {
+    if(storeIndex())
+      return true;
+
+    m_invalid = true;
+    setError({"invalid index data", url()});
+    return false;
+  }
+
+private:
+  bool storeIndex();
+
+  string m_baseHash;
+  bool m_compressed;
+  bool m_invalid;
+  string m_indexHash;
+};
+
+bool IndexDownload::storeIndex()
+{
+  const Path &file = path().temp();
+
+  string data;
+  if(!FS::read(file, &data))
+    return false;
+
+  const bool gzipped = m_compressed || Gzip::isCompressed(data);
+  if(gzipped && !Gzip::decompress(data, &data))
+    return false;
+
+  if(!IndexDelta::isDelta(data)) {
+    m_indexHash = Hash::sha256(data);
+
+    if(gzipped)
+      return true;
+  }
+  else {
+    if(m_baseHash.empty())
+      return false;
+
+    try {
+      const IndexDelta delta(data);
+
+      string base;
+      if(delta.baseHash() != m_baseHash || !readIndex(path().target(), &base))
+        return false;
+
+      data = delta.apply(base);
+      m_indexHash = delta.targetHash();
+    }
+    catch(const reapack_error &) {
+      return false;
+    }
+  }
+
+  string output;
+  return Gzip::compress(data, &output) && FS::write(file, output);
+}
+
 SynchronizeTask::SynchronizeTask(const Remote &remote, const bool stale,
     const bool fullSync, const InstallOpts &opts, Transaction *tx)
   : Task(tx), m_remote(remote), m_indexPath(Index::pathFor(m_remote.name())),
+    m_hashPath(Index::hashPathFor(m_remote.name())),
     m_opts(opts), m_stale(stale), m_fullSync(fullSync)
 {
 }
@@ -39,25 +145,121 @@ bool SynchronizeTask::start()
   FS::mtime(m_indexPath, &mtime);
 
   const time_t threshold = netConfig.staleThreshold;
-  if(!m_stale && mtime && (!threshold || mtime > now - threshold))
+  if(!m_stale && mtime && (!threshold || mtime > now - threshold)) {
+    update();
     return true;
+  }
+
+  // ask for a delta against the cached copy of the index
+  download(mtime ? cachedHash(mtime) : string());
+
+  return true;
+}
+
+// Reads the hash saved by IndexDownload next to the cached index, hashing the
+// index itself here would block the UI on large repositories.
+string SynchronizeTask::cachedHash(const time_t indexTime) const
+{
+  // the index was replaced by something else (eg. an archive import)
+  time_t hashTime;
+  if(!FS::mtime(m_hashPath, &hashTime) || hashTime < indexTime)
+    return {};
+
+  string hash;
+  if(!FS::read(m_hashPath, &hash) || hash.size() != 64)
+    return {};
+
+  return hash;
+}
+
+void SynchronizeTask::download(const string &baseHash,
+  const bool tryCompressed)
+{
+  string url = m_remote.url();
+
+  // Full indexes are fetched from index.xml.gz when the server has one.
+  // Delta requests use it too, so that the fallback full index of servers
+  // without delta support is also transferred compressed.
+  const bool compressed = tryCompressed && url.find('?') == string::npos &&
+    !boost::algorithm::ends_with(url, ".gz") &&
+    !g_noCompressedIndex.count(m_remote.url());
+
+  if(compressed)
+    url += ".gz";
+
+  // Servers without delta support send the full index
+  // (the query string is ignored by static file hosts).
+  if(!baseHash.empty())
+    url += (url.find('?') == string::npos ? "?since=" : "&since=") + baseHash;
+
+  // refreshing an expired index isn't something the user is waiting for
+  int flags = Download::NoCacheFlag;
+  if(!m_stale)
+    flags |= Download::BackgroundFlag;
 
-  auto dl = new FileDownload(m_indexPath, m_remote.url(),
-    netConfig, Download::NoCacheFlag);
+  auto dl = new IndexDownload(m_indexPath, url, baseHash, compressed, flags);
   dl->setName(m_remote.name());
 
+  // errors are reported below, once no fallback is left to try
+  dl->setOptional(true);
+  // indexes are needed before any package can be installed
+  dl->setPriority(numeric_limits<int64_t>::max());
+
   dl->onFinish([=] {
-    if(dl->save())
-      tx()->receipt()->setIndexChanged();
+    if(dl->state() == ThreadTask::Success) {
+      if(dl->save()) {
+        tx()->receipt()->setIndexChanged();
+
+        if(!FS::write(m_hashPath, dl->indexHash()))
+          FS::remove(m_hashPath);
+      }
+
+      ready();
+      return;
+    }
+
+    dl->save();
+
+    if(dl->state() != ThreadTask::Failure)
+      return;
+
+    if(dl->isInvalid()) {
+      // the delta could not be applied: fallback to a full download
+      if(!baseHash.empty()) {
+        download({}, compressed);
+        return;
+      }
+      // the server sent something else than a gzip file (eg. an error page)
+      else if(compressed) {
+        download({}, false);
+        return;
+      }
+    }
+    // no index.xml.gz next to the index: use the plain URL from now on
+    else if(compressed && dl->httpStatus() == 404) {
+      g_noCompressedIndex.insert(m_remote.url());
+      download(baseHash, false);
+      return;
+    }
+
+    tx()->receipt()->addError(dl->error());
+    ready(); // continue with the cached copy, if any
   });
 
   tx()->threadPool()->push(dl);
-  return true;
 }
 
-void SynchronizeTask::commit()
+void SynchronizeTask::ready()
+{
+  update();
+
+  // don't wait for the other indexes before installing this remote's packages
+  tx()->startQueued();
+}
+
+void SynchronizeTask::update()
 {
-  if(!FS::exists(m_indexPath))
+  if(tx()->isCancelled() || !FS::exists(m_indexPath))
     return;
 
   const IndexPtr &index = tx()->loadIndex(m_remote); // TODO: reuse m_indexPath
@@ -23,12 +23,14 @@
 #include "registry.hpp"
 #include "remote.hpp"
 
+#include <map>
 #include <memory>
 #include <set>
 #include <unordered_set>
 #include <vector>
 
 class ArchiveReader;
+class ArchiveWriter;
 class Index;
 class Source;
 class ThreadTask;
@@ -37,6 +39,7 @@ class Version;
 struct InstallOpts;
 
 typedef std::shared_ptr<ArchiveReader> ArchiveReaderPtr;
+typedef std::shared_ptr<ArchiveWriter> ArchiveWriterPtr;
 typedef std::shared_ptr<const Index> IndexPtr;
 
 class Task {
@@ -66,13 +69,18 @@ public:
 
 protected:
   bool start() override;
-  void commit() override;
+  void commit() override {} // the work is done once the index is ready
 
 private:
+  void download(const std::string &baseHash, bool tryCompressed = true);
+  void ready();
+  void update();
+  std::string cachedHash(time_t indexTime) const;
   void synchronize(const Package *);
 
   Remote m_remote;
   Path m_indexPath;
+  Path m_hashPath;
   InstallOpts m_opts;
   bool m_stale;
   bool m_fullSync;
@@ -88,7 +96,11 @@ public:
   void rollback() override;
 
 private:
+  void fetch(const Source *, int64_t expectedSize);
   void push(ThreadTask *, const TempPath &);
+  void wait(ThreadTask *);
+  bool replaceFiles();
+  Path backupPath(const Path &target) const;
 
   const Version *m_version;
   bool m_pin;
@@ -96,9 +108,13 @@ private:
   ArchiveReaderPtr m_reader;
 
   bool m_fail;
+  bool m_replaced;
   IndexPtr m_index; // keep in memory
   std::vector<Registry::File> m_oldFiles;
   std::vector<TempPath> m_newFiles;
+  std::vector<Path> m_replacedFiles;
+  std::vector<Path> m_backups;
+  std::map<Path, std::string> m_hashes;
   std::unordered_set<ThreadTask *> m_waiting;
 };
 
@@ -129,9 +145,30 @@ private:
   bool m_pin;
 };
 
+class ImportTask : public Task {
+public:
+  ImportTask(const Remote &, const std::vector<std::string> &packages,
+    const ArchiveReaderPtr &, const std::string &archive, Transaction *);
+
+protected:
+  bool start() override;
+  void commit() override;
+
+private:
+  void ready(const IndexPtr &);
+  void importPackage(const std::string &);
+
+  Remote m_remote;
+  std::vector<std::string> m_packages;
+  ArchiveReaderPtr m_reader;
+  std::string m_archive;
+  IndexPtr m_index; // keep in memory
+};
+
 class ExportTask : public Task {
 public:
-  ExportTask(const std::string &path, Transaction *);
+  // Only files that changed since the base archive (if any) are written.
+  ExportTask(const std::string &path, const std::string &base, Transaction *);
 
 protected:
   bool start() override;
@@ -139,7 +176,14 @@ protected:
   void rollback() override;
 
 private:
+  typedef std::map<std::string, std::string> Manifest; // path => hash
+
+  bool readBaseManifest(Manifest *);
+
   TempPath m_path;
+  std::string m_base;
+  ArchiveWriterPtr m_writer;
+  Manifest m_manifest;
 };
 
 #endif
@@ -18,6 +18,7 @@
 #include "thread.hpp"
 
 #include "download.hpp"
+#include "trace.hpp"
 
 #include <reaper_plugin_functions.h>
 
@@ -26,7 +27,8 @@ using namespace std;
 ThreadNotifier *ThreadNotifier::s_instance = nullptr;
 
 ThreadTask::ThreadTask()
-  : m_state(Idle), m_abort(false)
+  : m_state(Idle), m_optional(false), m_priority(0), m_groupLimit(0),
+    m_abort(false)
 {
   ThreadNotifier::get()->start();
 }
@@ -61,7 +63,12 @@ void ThreadTask::start()
 {
   WorkerThread *thread = new WorkerThread;
   thread->push(this);
-  onFinish([thread] { delete thread; });
+
+  // connected last so that it runs after every other onFinish slots
+  m_onFinish.connect([=] {
+    delete thread;
+    delete this;
+  });
 }
 
 void ThreadTask::onFinish(const VoidSignal::slot_type &slot)
@@ -85,7 +92,7 @@ void ThreadTask::exec()
   ThreadNotifier::get()->notify({this, state});
 };
 
-WorkerThread::WorkerThread() : m_exit(false)
+WorkerThread::WorkerThread(ThreadPool *pool) : m_pool(pool), m_exit(false)
 {
   m_wake = CreateEvent(nullptr, true, false, nullptr);
   m_thread = CreateThread(nullptr, 0, [](void *ptr) -> DWORD {
@@ -109,29 +116,46 @@ void WorkerThread::run()
 {
   DownloadContext context;
 
-  while(!m_exit) {
-    while(ThreadTask *task = nextTask()) {
+  while(true) {
+    // reset before looking for work so that a push made while
+    // the queues are being drained is not missed
+    ResetEvent(m_wake);
+
+    if(m_exit)
+      break;
+
+    string group;
+
+    while(ThreadTask *task = nextTask(&group)) {
       if(auto dl = dynamic_cast<Download *>(task))
         dl->setContext(&context);
 
+      // the task may be deleted by the main thread once exec() returns
       task->exec();
+
+      if(!group.empty())
+        m_pool->releaseGroup(group);
     }
 
-    ResetEvent(m_wake);
     WaitForSingleObject(m_wake, INFINITE);
   }
 }
 
-ThreadTask *WorkerThread::nextTask()
+ThreadTask *WorkerThread::nextTask(string *group)
 {
-  WDL_MutexLock lock(&m_mutex);
+  group->clear();
 
-  if(m_queue.empty())
-    return nullptr;
+  {
+    WDL_MutexLock lock(&m_mutex);
 
-  ThreadTask *task = m_queue.front();
-  m_queue.pop();
-  return task;
+    if(!m_queue.empty()) {
+      ThreadTask *task = m_queue.front();
+      m_queue.pop();
+      return task;
+    }
+  }
+
+  return m_pool ? m_pool->nextTask(group) : nullptr;
 }
 
 void WorkerThread::push(ThreadTask *task)
@@ -143,6 +167,11 @@ void WorkerThread::push(ThreadTask *task)
   SetEvent(m_wake);
 }
 
+void WorkerThread::wake()
+{
+  SetEvent(m_wake);
+}
+
 ThreadPool::~ThreadPool()
 {
   // don't emit ThreadPool::onAbort from the destructor
@@ -156,9 +185,11 @@ void ThreadPool::push(ThreadTask *task)
 {
   m_onPush(task);
   m_running.insert(task);
+  Trace::counter("running tasks", m_running.size());
 
   task->onFinish([=] {
     m_running.erase(task);
+    Trace::counter("running tasks", m_running.size());
 
     delete task;
 
@@ -170,9 +201,67 @@ void ThreadPool::push(ThreadTask *task)
   const size_t nextThread = m_running.size() % m_pool.size();
   auto &thread = task->concurrent() ? m_pool[nextThread] : m_pool.front();
   if(!thread)
-    thread = make_unique<WorkerThread>();
+    thread = make_unique<WorkerThread>(this);
+
+  if(!task->concurrent()) {
+    thread->push(task);
+    return;
+  }
+
+  {
+    WDL_MutexLock lock(&m_mutex);
+
+    task->setState(ThreadTask::Queued);
+    m_queue.push({task, m_pushCount++});
+  }
+
+  for(const auto &worker : m_pool) {
+    if(worker)
+      worker->wake();
+  }
+}
+
+ThreadTask *ThreadPool::nextTask(string *group)
+{
+  WDL_MutexLock lock(&m_mutex);
+
+  // tasks whose group is busy are skipped, the worker finishing one of
+  // the group's tasks will pick them up
+  vector<PendingTask> skipped;
+  ThreadTask *task = nullptr;
+
+  while(!m_queue.empty()) {
+    const PendingTask next = m_queue.top();
+    m_queue.pop();
+
+    const unsigned int limit = next.task->groupLimit();
+    const auto &active = m_activeGroups.find(next.task->group());
+    if(limit && active != m_activeGroups.end() && active->second >= limit) {
+      skipped.push_back(next);
+      continue;
+    }
+
+    task = next.task;
+    break;
+  }
+
+  for(const PendingTask &pending : skipped)
+    m_queue.push(pending);
+
+  if(task && task->groupLimit()) {
+    *group = task->group();
+    ++m_activeGroups[*group];
+  }
+
+  return task;
+}
+
+void ThreadPool::releaseGroup(const string &group)
+{
+  WDL_MutexLock lock(&m_mutex);
 
-  thread->push(task);
+  if(!--m_activeGroups[group])
+    m_activeGroups.erase(group);
 }
 
 void ThreadPool::abort()
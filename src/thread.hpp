@@ -23,6 +23,7 @@
 #include <array>
 #include <atomic>
 #include <functional>
+#include <map>
 #include <queue>
 #include <unordered_set>
 
@@ -53,7 +54,7 @@ public:
 
   virtual bool concurrent() const = 0;
 
-  void start(); // start a new thread
+  void start(); // start a new thread, the task is deleted once finished
   void exec();  // runs in the current thread
   const std::string &summary() const { return m_summary; }
   void setState(State);
@@ -61,6 +62,19 @@ public:
   void setError(const ErrorInfo &err) { m_error = err; }
   const ErrorInfo &error() { return m_error; }
 
+  // failures of optional tasks are handled by their owner and not reported
+  void setOptional(bool optional) { m_optional = optional; }
+  bool optional() const { return m_optional; }
+
+  // tasks with a higher priority are run first by ThreadPool
+  void setPriority(int64_t priority) { m_priority = priority; }
+  int64_t priority() const { return m_priority; }
+  // at most `limit` tasks of the same group are run at once (0 = no limit)
+  void setGroup(const std::string &group, unsigned int limit)
+    { m_group = group; m_groupLimit = limit; }
+  const std::string &group() const { return m_group; }
+  unsigned int groupLimit() const { return m_groupLimit; }
+
   void onStart(const VoidSignal::slot_type &slot) { m_onStart.connect(slot); }
   void onFinish(const VoidSignal::slot_type &slot);
 
@@ -76,24 +90,31 @@ private:
   std::string m_summary;
   State m_state;
   ErrorInfo m_error;
+  bool m_optional;
+  int64_t m_priority;
+  std::string m_group;
+  unsigned int m_groupLimit;
   std::atomic_bool m_abort;
 
   VoidSignal m_onStart;
   VoidSignal m_onFinish;
 };
 
+class ThreadPool;
+
 class WorkerThread {
 public:
-  WorkerThread();
+  WorkerThread(ThreadPool * = nullptr);
   ~WorkerThread();
 
   void push(ThreadTask *);
-  void clear();
+  void wake();
 
 private:
   void run();
-  ThreadTask *nextTask();
+  ThreadTask *nextTask(std::string *group);
 
+  ThreadPool *m_pool;
   HANDLE m_wake;
   HANDLE m_thread;
   std::atomic_bool m_exit;
@@ -106,7 +127,7 @@ public:
   typedef boost::signals2::signal<void ()> VoidSignal;
   typedef boost::signals2::signal<void (ThreadTask *)> TaskSignal;
 
-  ThreadPool() {}
+  ThreadPool() : m_pushCount(0) {}
   ThreadPool(const ThreadPool &) = delete;
   ~ThreadPool();
 
@@ -120,6 +141,32 @@ public:
   void onDone(const VoidSignal::slot_type &slot) { m_onDone.connect(slot); }
 
 private:
+  friend WorkerThread;
+
+  struct PendingTask {
+    ThreadTask *task;
+    size_t order;
+
+    bool operator<(const PendingTask &o) const
+    {
+      if(task->priority() == o.task->priority())
+        return order > o.order;
+      else
+        return task->priority() < o.task->priority();
+    }
+  };
+
+  // called from the worker threads
+  ThreadTask *nextTask(std::string *group);
+  void releaseGroup(const std::string &group);
+
+  // concurrent tasks are shared by every worker, by priority then FIFO
+  // (declared before m_pool so the threads are stopped first)
+  WDL_Mutex m_mutex;
+  std::priority_queue<PendingTask> m_queue;
+  std::map<std::string, unsigned int> m_activeGroups;
+  size_t m_pushCount;
+
   std::array<std::unique_ptr<WorkerThread>, 3> m_pool;
   std::unordered_set<ThreadTask *> m_running;
 
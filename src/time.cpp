@@ -56,6 +56,16 @@ string Time::toString() const
   return buf;
 }
 
+int64_t Time::packed() const
+{
+  int64_t key = year();
+
+  for(const int field : {month(), day(), hour(), minute(), second()})
+    key = (key << 6) | field;
+
+  return key;
+}
+
 int Time::compare(const Time &o) const
 {
   const array<int, 6> l{year(), month(), day(), hour(), minute(), second()};
@@ -18,6 +18,7 @@
 #ifndef REAPACK_TIME_HPP
 #define REAPACK_TIME_HPP
 
+#include <cstdint>
 #include <ctime>
 #include <string>
 
@@ -40,6 +41,7 @@ public:
   std::string toString() const;
 
   int compare(const Time &) const;
+  int64_t packed() const; // ordered like compare()
   bool operator<(const Time &o) const { return compare(o) < 0; }
   bool operator<=(const Time &o) const { return compare(o) <= 0; }
   bool operator>(const Time &o) const { return compare(o) > 0; }
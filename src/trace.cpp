@@ -0,0 +1,162 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "trace.hpp"
+
+#include "filesystem.hpp"
+#include "path.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#include <WDL/mutex.h>
+
+using namespace std;
+
+// only the most recent events are kept
+static const size_t MAX_EVENTS = 100000;
+
+struct Event {
+  const char *name;
+  string detail;
+  char phase;
+  int64_t time;
+  int64_t value; // duration of spans or value of counters
+  thread::id threadId;
+};
+
+static WDL_Mutex g_mutex;
+static deque<Event> g_events;
+
+static int64_t now()
+{
+  using namespace chrono;
+
+  static const auto epoch = steady_clock::now();
+  return duration_cast<microseconds>(steady_clock::now() - epoch).count();
+}
+
+static void record(Event &&event)
+{
+  event.threadId = this_thread::get_id();
+
+  WDL_MutexLock lock(&g_mutex);
+
+  g_events.push_back(move(event));
+
+  if(g_events.size() > MAX_EVENTS)
+    g_events.pop_front();
+}
+
+static void writeString(ostream &stream, const string &text)
+{
+  stream << '"';
+
+  for(const char c : text) {
+    switch(c) {
+    case '"':
+    case '\\':
+      stream << '\\' << c;
+      break;
+    default:
+      if((unsigned char)c < 0x20) {
+        char escaped[7];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)c);
+        stream << escaped;
+      }
+      else
+        stream << c;
+      break;
+    }
+  }
+
+  stream << '"';
+}
+
+Trace::Span::Span(const char *name, const string &detail)
+  : m_name(name), m_detail(detail), m_start(now())
+{
+}
+
+Trace::Span::~Span()
+{
+  record({m_name, move(m_detail), 'X', m_start, now() - m_start});
+}
+
+void Trace::counter(const char *name, const int64_t value)
+{
+  record({name, {}, 'C', now(), value});
+}
+
+void Trace::write(ostream &stream)
+{
+  deque<Event> events;
+  {
+    WDL_MutexLock lock(&g_mutex);
+    events = g_events;
+  }
+
+  // small sequential thread numbers are easier to read than native ids
+  map<thread::id, int> threads;
+
+  stream << "{\"traceEvents\":[";
+
+  for(auto it = events.begin(); it != events.end(); ++it) {
+    const Event &event = *it;
+    const auto tid = threads.emplace(event.threadId, (int)threads.size() + 1);
+
+    if(it != events.begin())
+      stream << ',';
+
+    stream << "\n{\"name\":";
+    writeString(stream, event.name);
+    stream << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.time
+      << ",\"pid\":1,\"tid\":" << tid.first->second;
+
+    if(event.phase == 'C') {
+      stream << ",\"args\":{";
+      writeString(stream, event.name);
+      stream << ':' << event.value << '}';
+    }
+    else {
+      stream << ",\"dur\":" << event.value;
+
+      if(!event.detail.empty()) {
+        stream << ",\"args\":{\"detail\":";
+        writeString(stream, event.detail);
+        stream << '}';
+      }
+    }
+
+    stream << '}';
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Trace::save(const Path &path)
+{
+  ostringstream stream;
+  write(stream);
+
+  return FS::write(path, stream.str());
+}
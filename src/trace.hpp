@@ -0,0 +1,49 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef REAPACK_TRACE_HPP
+#define REAPACK_TRACE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class Path;
+
+// Timing of the slow paths, kept in memory and exported on demand in the
+// Chrome trace event format (chrome://tracing or ui.perfetto.dev).
+namespace Trace {
+  class Span {
+  public:
+    Span(const char *name, const std::string &detail = {});
+    Span(const Span &) = delete;
+    ~Span();
+
+  private:
+    const char *m_name;
+    std::string m_detail;
+    int64_t m_start;
+  };
+
+  void counter(const char *name, int64_t value);
+
+  void write(std::ostream &);
+  bool save(const Path &);
+};
+
+#endif
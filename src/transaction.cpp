@@ -31,12 +31,21 @@
 using namespace std;
 
 Transaction::Transaction()
-  : m_isCancelled(false), m_registry(Path::REGISTRY.prependRoot())
+  : m_span("Transaction"), m_isCancelled(false), m_earlyStart(false),
+    m_registry(Path::REGISTRY.prependRoot())
 {
+  static unsigned int count = 0;
+  m_backupDir = Path::DATA + "backup" + String::format("%lld-%u",
+    (long long)time(nullptr), ++count);
+
   m_threadPool.onPush([this] (ThreadTask *task) {
     task->onFinish([=] {
-      if(task->state() == ThreadTask::Failure)
+      if(task->state() == ThreadTask::Failure && !task->optional())
         m_receipt.addError(task->error());
+
+      const Download *dl = dynamic_cast<const Download *>(task);
+      if(dl && task->state() != ThreadTask::Aborted)
+        m_receipt.addDownload(dl->stats());
     });
   });
 
@@ -128,6 +137,8 @@ void Transaction::uninstall(const Remote &remote)
       m_receipt.addError({FS::lastError(), indexPath.join()});
   }
 
+  FS::remove(Index::hashPathFor(remote.name()));
+
   for(const auto &entry : m_registry.getEntries(remote.name()))
     uninstall(entry);
 }
@@ -137,13 +148,23 @@ void Transaction::uninstall(const Registry::Entry &entry)
   m_nextQueue.push(make_shared<UninstallTask>(entry, this));
 }
 
-void Transaction::exportArchive(const string &path)
+void Transaction::exportArchive(const string &path, const string &base)
+{
+  m_nextQueue.push(make_shared<ExportTask>(path, base, this));
+}
+
+void Transaction::importRemote(const Remote &remote,
+  const vector<string> &packages, const ArchiveReaderPtr &reader,
+  const string &archive)
 {
-  m_nextQueue.push(make_shared<ExportTask>(path, this));
+  m_nextQueue.push(make_shared<ImportTask>(remote, packages, reader,
+    archive, this));
 }
 
 bool Transaction::runTasks()
 {
+  Trace::Span span("Transaction::runTasks");
+
   do {
     if(!m_nextQueue.empty()) {
       m_taskQueues.push(m_nextQueue);
@@ -163,6 +184,10 @@ bool Transaction::runTasks()
       runQueue(m_taskQueues.front());
       m_taskQueues.pop();
 
+      // tasks queued by the ones above don't have to wait for the downloads
+      if(!m_threadPool.idle())
+        startQueued();
+
       if(!commitTasks())
         return false; // if the tasks didn't finish immediately (downloading)
     }
@@ -176,7 +201,31 @@ bool Transaction::runTasks()
 void Transaction::runQueue(TaskQueue &queue)
 {
   m_registry.savepoint();
+  startTasks(queue);
+  m_registry.restore();
+}
+
+// Starts the tasks queued so far alongside the running ones instead of
+// waiting for the next phase. They are committed with the current phase.
+void Transaction::startQueued()
+{
+  if(m_isCancelled || m_nextQueue.empty())
+    return;
+
+  // The registry changes made by start() are kept until the phase is
+  // committed so file conflicts are detected across every early batch.
+  if(!m_earlyStart) {
+    m_registry.savepoint();
+    m_earlyStart = true;
+  }
+
+  TaskQueue queue;
+  queue.swap(m_nextQueue);
+  startTasks(queue);
+}
 
+void Transaction::startTasks(TaskQueue &queue)
+{
   while(!queue.empty()) {
     const TaskPtr &task = queue.top();
 
@@ -185,8 +234,6 @@ void Transaction::runQueue(TaskQueue &queue)
 
     queue.pop();
   }
-
-  m_registry.restore();
 }
 
 bool Transaction::commitTasks()
@@ -195,6 +242,11 @@ bool Transaction::commitTasks()
   if(!m_threadPool.idle())
     return false;
 
+  if(m_earlyStart) {
+    m_registry.restore();
+    m_earlyStart = false;
+  }
+
   // finish current tasks
   while(!m_runningTasks.empty()) {
     if(m_isCancelled)
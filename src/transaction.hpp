@@ -22,6 +22,7 @@
 #include "registry.hpp"
 #include "task.hpp"
 #include "thread.hpp"
+#include "trace.hpp"
 
 #include <boost/optional.hpp>
 #include <boost/signals2.hpp>
@@ -31,6 +32,7 @@
 #include <unordered_set>
 
 class ArchiveReader;
+class ImportTask;
 class InstallTask;
 class Path;
 class Remote;
@@ -63,17 +65,22 @@ public:
   void setPinned(const Registry::Entry &, bool pinned);
   void uninstall(const Remote &);
   void uninstall(const Registry::Entry &);
-  void exportArchive(const std::string &path);
+  void exportArchive(const std::string &path, const std::string &base = {});
+  void importRemote(const Remote &, const std::vector<std::string> &packages,
+    const ArchiveReaderPtr &, const std::string &archive);
   bool runTasks();
 
   bool isCancelled() const { return m_isCancelled; }
 
   Receipt *receipt() { return &m_receipt; }
+  // where InstallTask keeps the files it replaces until commit or rollback
+  const Path &backupDir() const { return m_backupDir; }
   Registry *registry() { return &m_registry; }
   ThreadPool *threadPool() { return &m_threadPool; }
 
 protected:
   friend SynchronizeTask;
+  friend ImportTask;
   friend InstallTask;
   friend UninstallTask;
 
@@ -81,6 +88,7 @@ protected:
   void addObsolete(const Registry::Entry &e) { m_obsolete.insert(e); }
   void registerAll(bool add, const Registry::Entry &);
   void registerFile(const HostTicket &t) { m_regQueue.push(t); }
+  void startQueued();
 
 private:
   class CompareTask {
@@ -99,12 +107,16 @@ private:
   void inhibit(const Remote &);
   void promptObsolete();
   void runQueue(TaskQueue &queue);
+  void startTasks(TaskQueue &queue);
   bool commitTasks();
   void finish();
 
+  Trace::Span m_span; // whole lifetime of the transaction
   bool m_isCancelled;
+  bool m_earlyStart;
   Registry m_registry;
   Receipt m_receipt;
+  Path m_backupDir;
 
   std::unordered_set<std::string> m_syncedRemotes;
   std::map<std::string, IndexPtr> m_indexes;
@@ -0,0 +1,99 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trigram.hpp"
+
+#include <algorithm>
+#include <boost/algorithm/string/case_conv.hpp>
+
+using namespace std;
+
+static const size_t TRIGRAM_SIZE = 3;
+
+auto TrigramIndex::trigram(const char *str) -> Trigram
+{
+  return
+    static_cast<unsigned char>(str[0]) << 16 |
+    static_cast<unsigned char>(str[1]) << 8 |
+    static_cast<unsigned char>(str[2]);
+}
+
+void TrigramIndex::add(const size_t document, const string &text)
+{
+  if(document >= m_size)
+    m_size = document + 1;
+
+  if(text.size() < TRIGRAM_SIZE)
+    return;
+
+  const string &lower = boost::algorithm::to_lower_copy(text);
+
+  for(size_t i = 0; i + TRIGRAM_SIZE <= lower.size(); ++i) {
+    PostingList &list = m_postings[trigram(&lower[i])];
+
+    // keep the list sorted and free of duplicates
+    if(list.empty() || list.back() < document)
+      list.push_back(static_cast<uint32_t>(document));
+  }
+}
+
+void TrigramIndex::clear()
+{
+  m_postings.clear();
+  m_size = 0;
+}
+
+bool TrigramIndex::lookup(const string &needle, vector<size_t> *out) const
+{
+  out->clear();
+
+  if(needle.size() < TRIGRAM_SIZE)
+    return false;
+
+  const string &lower = boost::algorithm::to_lower_copy(needle);
+
+  vector<const PostingList *> lists;
+  lists.reserve(lower.size() - TRIGRAM_SIZE + 1);
+
+  for(size_t i = 0; i + TRIGRAM_SIZE <= lower.size(); ++i) {
+    const auto &it = m_postings.find(trigram(&lower[i]));
+
+    if(it == m_postings.end())
+      return true; // no document can possibly match
+
+    lists.push_back(&it->second);
+  }
+
+  // intersect starting with the shortest lists to keep the work set small
+  sort(lists.begin(), lists.end(),
+    [](const PostingList *a, const PostingList *b) { return a->size() < b->size(); });
+
+  out->assign(lists.front()->begin(), lists.front()->end());
+
+  for(auto it = lists.begin() + 1; it != lists.end() && !out->empty(); ++it) {
+    const PostingList &list = **it;
+
+    const auto &end = remove_if(out->begin(), out->end(),
+      [&list](const size_t doc) {
+        return !binary_search(list.begin(), list.end(), doc);
+      });
+
+    out->erase(end, out->end());
+  }
+
+  return true;
+}
@@ -0,0 +1,52 @@
+/* ReaPack: Package manager for REAPER
+ * Copyright (C) 2015-2017  Christian Fillion
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REAPACK_TRIGRAM_HPP
+#define REAPACK_TRIGRAM_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Inverted index of the case-insensitive trigrams contained in a set of
+// documents. Used to quickly narrow down the candidates of a substring search
+// before doing the exact (and much slower) matching.
+class TrigramIndex {
+public:
+  TrigramIndex() : m_size(0) {}
+
+  // Documents must be added in ascending order
+  void add(size_t document, const std::string &text);
+  void clear();
+  size_t size() const { return m_size; }
+
+  // Fills out with every document potentially containing the needle (sorted).
+  // Returns false if the needle is too short to be looked up in the index.
+  bool lookup(const std::string &needle, std::vector<size_t> *out) const;
+
+private:
+  typedef uint32_t Trigram;
+  typedef std::vector<uint32_t> PostingList;
+
+  static Trigram trigram(const char *);
+
+  std::unordered_map<Trigram, PostingList> m_postings;
+  size_t m_size;
+};
+
+#endif
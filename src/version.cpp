@@ -164,6 +164,34 @@ auto VersionName::segment(const size_t index) const -> Segment
     return 0;
 }
 
+bool VersionName::packed(uint64_t *key) const
+{
+  constexpr size_t maxSegments = 4;
+
+  if(m_segments.empty() || m_segments.size() > maxSegments)
+    return false;
+
+  uint64_t packed = 0;
+
+  for(size_t i = 0; i < maxSegments; i++) {
+    Numeric number = 0;
+
+    if(i < size()) {
+      const Numeric *segment = boost::get<Numeric>(&m_segments[i]);
+
+      if(!segment)
+        return false;
+
+      number = *segment;
+    }
+
+    packed = (packed << 16) | number;
+  }
+
+  *key = packed;
+  return true;
+}
+
 int VersionName::compare(const VersionName &o) const
 {
   const size_t biggest = max(size(), o.size());
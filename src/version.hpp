@@ -44,6 +44,9 @@ public:
   const std::string &toString() const { return m_string; }
 
   int compare(const VersionName &) const;
+  // Fits up to four numeric segments in an integer ordered like compare().
+  // Returns false if the version cannot be packed.
+  bool packed(uint64_t *key) const;
   bool operator<(const VersionName &o) const { return compare(o) < 0; }
   bool operator<=(const VersionName &o) const { return compare(o) <= 0; }
   bool operator>(const VersionName &o) const { return compare(o) > 0; }
@@ -15,6 +15,16 @@ TEST_CASE("open unicode file", M) {
   fclose(file);
 }
 
+TEST_CASE("read file contents", M) {
+  UseRootPath root(RIPATH);
+
+  std::string contents;
+  REQUIRE(FS::read(Index::pathFor("Новая папка"), &contents));
+  REQUIRE(contents == "<index version=\"1\"/>\n");
+
+  REQUIRE_FALSE(FS::read(Index::pathFor("404"), &contents));
+}
+
 TEST_CASE("file modification time", M) {
   UseRootPath root(RIPATH);
   const Path &path = Index::pathFor("Новая папка");
@@ -24,6 +34,16 @@ TEST_CASE("file modification time", M) {
   REQUIRE(time > 0);
 }
 
+TEST_CASE("file size", M) {
+  UseRootPath root(RIPATH);
+
+  int64_t size = 0;
+  REQUIRE(FS::size(Index::pathFor("Новая папка"), &size));
+  REQUIRE(size == 21);
+
+  REQUIRE_FALSE(FS::size(Index::pathFor("404"), &size));
+}
+
 TEST_CASE("file exists", M) {
   UseRootPath root(RIPATH);
 
@@ -1,6 +1,7 @@
 #include "helper.hpp"
 
 #include <filter.hpp>
+#include <trigram.hpp>
 
 using namespace std;
 
@@ -31,6 +32,20 @@ TEST_CASE("get/set filter", M) {
   REQUIRE(f.match({"world"}));
 }
 
+TEST_CASE("empty filter", M) {
+  Filter f;
+  REQUIRE(f.empty());
+
+  f.set("  ");
+  REQUIRE(f.empty());
+
+  f.set("hello");
+  REQUIRE_FALSE(f.empty());
+
+  f.set("");
+  REQUIRE(f.empty());
+}
+
 TEST_CASE("filter operators", M) {
   SECTION("assignment") {
     Filter f;
@@ -323,3 +338,74 @@ TEST_CASE("AND grouping", M) {
     REQUIRE_FALSE(f.match({"bacon"}));
   }
 }
+
+TEST_CASE("filter candidates from trigram index", M) {
+  TrigramIndex ti;
+  ti.add(0, "hello world");
+  ti.add(1, "chunky bacon");
+  ti.add(2, "hello bacon");
+
+  Filter f;
+  vector<size_t> docs;
+
+  SECTION("empty filter") {
+    REQUIRE_FALSE(f.candidates(ti, &docs));
+  }
+
+  SECTION("single word") {
+    f.set("bacon");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == (vector<size_t>{1, 2}));
+  }
+
+  SECTION("AND") {
+    f.set("hello bacon");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == vector<size_t>{2});
+  }
+
+  SECTION("OR") {
+    f.set("world OR chunky");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == (vector<size_t>{0, 1}));
+  }
+
+  SECTION("short words are ignored") {
+    f.set("he bacon");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == (vector<size_t>{1, 2}));
+  }
+
+  SECTION("OR with a short word") {
+    f.set("world OR he");
+    REQUIRE_FALSE(f.candidates(ti, &docs));
+  }
+
+  SECTION("NOT") {
+    f.set("NOT bacon");
+    REQUIRE_FALSE(f.candidates(ti, &docs));
+  }
+
+  SECTION("NOT in conjunction") {
+    f.set("hello NOT bacon");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == (vector<size_t>{0, 2}));
+  }
+
+  SECTION("anchors and quotes") {
+    f.set("^hello \"bacon\"$");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == vector<size_t>{2});
+  }
+
+  SECTION("quoted phrase") {
+    f.set("'chunky bacon'");
+    REQUIRE(f.candidates(ti, &docs));
+    REQUIRE(docs == vector<size_t>{1});
+  }
+
+  SECTION("negated group") {
+    f.set("NOT ( hello world )");
+    REQUIRE_FALSE(f.candidates(ti, &docs));
+  }
+}
@@ -0,0 +1,62 @@
+#include "helper.hpp"
+
+#include <gzip.hpp>
+
+using namespace std;
+
+static const char *M = "[gzip]";
+
+TEST_CASE("detect gzip data", M) {
+  REQUIRE_FALSE(Gzip::isCompressed({}));
+  REQUIRE_FALSE(Gzip::isCompressed("<index/>"));
+  REQUIRE(Gzip::isCompressed("\x1f\x8b\x08"));
+}
+
+TEST_CASE("gzip round trip", M) {
+  string input;
+  for(int i = 0; i < 10000; i++)
+    input += "<version name=\"" + to_string(i) + "\"/>\n";
+
+  string compressed;
+  REQUIRE(Gzip::compress(input, &compressed));
+  REQUIRE(Gzip::isCompressed(compressed));
+  REQUIRE(compressed.size() < input.size());
+
+  string output;
+  REQUIRE(Gzip::decompress(compressed, &output));
+  REQUIRE(output == input);
+}
+
+TEST_CASE("decompress gzip data", M) {
+  // printf hello | gzip -n
+  const string data("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03\xcb\x48\xcd\xc9"
+    "\xc9\x07\x00\x86\xa6\x10\x36\x05\x00\x00\x00", 25);
+
+  string output;
+  REQUIRE(Gzip::decompress(data, &output));
+  REQUIRE(output == "hello");
+}
+
+TEST_CASE("decompress invalid gzip data", M) {
+  string output = "untouched";
+
+  SECTION("garbage") {
+    REQUIRE_FALSE(Gzip::decompress("\x1f\x8b garbage", &output));
+  }
+
+  SECTION("truncated") {
+    string compressed;
+    Gzip::compress("hello world", &compressed);
+    compressed.resize(compressed.size() - 4);
+    REQUIRE_FALSE(Gzip::decompress(compressed, &output));
+  }
+
+  SECTION("trailing data") {
+    string compressed;
+    Gzip::compress("hello world", &compressed);
+    compressed += "trailing";
+    REQUIRE_FALSE(Gzip::decompress(compressed, &output));
+  }
+
+  REQUIRE(output == "untouched");
+}
@@ -0,0 +1,36 @@
+#include "helper.hpp"
+
+#include <hash.hpp>
+
+using namespace std;
+
+static const char *M = "[hash]";
+
+TEST_CASE("sha256 digest", M) {
+  SECTION("empty") {
+    REQUIRE(Hash::sha256({}) ==
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  }
+
+  SECTION("short") {
+    REQUIRE(Hash::sha256("abc") ==
+      "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  }
+
+  SECTION("two blocks") {
+    REQUIRE(Hash::sha256(
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  }
+}
+
+TEST_CASE("sha256 incremental digest", M) {
+  const string data(1000, 'a');
+
+  Hash hash;
+  for(size_t i = 0; i < data.size(); i += 7)
+    hash.addData(data.substr(i, 7));
+
+  REQUIRE(hash.digest() == Hash::sha256(data));
+  REQUIRE(hash.digest() == Hash::sha256(data)); // stays the same
+}
@@ -84,6 +84,25 @@ TEST_CASE("future version", M) {
   }
 }
 
+TEST_CASE("load compressed index", M) {
+  UseRootPath root(RIPATH);
+
+  IndexPtr ri = Index::load("compressed");
+  REQUIRE(ri->name() == "compressed");
+}
+
+TEST_CASE("corrupted compressed index", M) {
+  UseRootPath root(RIPATH);
+
+  try {
+    IndexPtr ri = Index::load("corrupted_cache");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "corrupted index cache");
+  }
+}
+
 TEST_CASE("add a category", M) {
   Index ri("a");
   Category *cat = new Category("a", &ri);
@@ -0,0 +1,94 @@
+#include "helper.hpp"
+
+#include <errors.hpp>
+#include <hash.hpp>
+#include <index_delta.hpp>
+
+using namespace std;
+
+static const char *M = "[index_delta]";
+
+TEST_CASE("create and apply delta", M) {
+  const string base = "<index><a/><b/></index>";
+  string target;
+
+  SECTION("insertion") { target = "<index><a/><new/><b/></index>"; }
+  SECTION("deletion") { target = "<index><b/></index>"; }
+  SECTION("identical") { target = base; }
+  SECTION("from scratch") { target = "hello world"; }
+
+  const string data = IndexDelta::create(base, target);
+  REQUIRE(IndexDelta::isDelta(data));
+
+  const IndexDelta delta(data);
+  REQUIRE(delta.baseHash() == Hash::sha256(base));
+  REQUIRE(delta.targetHash() == Hash::sha256(target));
+  REQUIRE(delta.apply(base) == target);
+}
+
+TEST_CASE("apply delta to the wrong base", M) {
+  const IndexDelta delta(IndexDelta::create("hello world", "hello there"));
+
+  try {
+    delta.apply("hello there");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "delta base mismatch");
+  }
+}
+
+TEST_CASE("full index is not a delta", M) {
+  REQUIRE_FALSE(IndexDelta::isDelta("<index version=\"1\"/>"));
+
+  try {
+    IndexDelta delta("<index version=\"1\"/>");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "invalid delta header");
+  }
+}
+
+static const string HEADER = "RPDELTA 1\n" + Hash::sha256("abc") + '\n' +
+  Hash::sha256("abc") + '\n';
+
+TEST_CASE("unknown delta operation", M) {
+  try {
+    IndexDelta delta(HEADER + "X 1\n");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "invalid delta operation");
+  }
+}
+
+TEST_CASE("malformed delta", M) {
+  string data = HEADER;
+
+  SECTION("truncated insertion") { data += "I 10\nabc"; }
+  SECTION("negative insertion length") { data += "I -1\nabc"; }
+  SECTION("huge insertion length") { data += "I 18446744073709551615\n"; }
+  SECTION("missing insertion length") { data += "I\nabc"; }
+  SECTION("negative copy length") { data += "C 0 -1\n"; }
+
+  try {
+    IndexDelta delta(data);
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "corrupted index delta");
+  }
+}
+
+TEST_CASE("delta copy out of range", M) {
+  const IndexDelta delta(HEADER + "C 1 10\n");
+
+  try {
+    delta.apply("abc");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "delta copy out of range");
+  }
+}
@@ -0,0 +1,90 @@
+#include "helper.hpp"
+
+#include <index.hpp>
+#include <index_diff.hpp>
+
+using namespace std;
+
+static const char *M = "[index_diff]";
+
+static const Package *addPackage(Index *ri, const string &pkgName,
+  const string &verName, const string &author = {})
+{
+  Category *cat = new Category("cat", ri);
+  Package *pkg = new Package(Package::ScriptType, pkgName, cat);
+  Version *ver = new Version(verName, pkg);
+  ver->setAuthor(author);
+  ver->addSource(new Source({}, "google.com", ver));
+  pkg->addVersion(ver);
+  cat->addPackage(pkg);
+  ri->addCategory(cat);
+
+  return pkg;
+}
+
+TEST_CASE("diff identical indexes", M) {
+  Index before("a"), after("a");
+  addPackage(&before, "pkg", "1.0");
+  const Package *pkg = addPackage(&after, "pkg", "1.0");
+
+  const IndexDiff diff(&before, &after);
+  REQUIRE(diff.empty());
+  REQUIRE_FALSE(diff.changed(pkg));
+}
+
+TEST_CASE("diff added and removed packages", M) {
+  Index before("a"), after("a");
+  const Package *removed = addPackage(&before, "old", "1.0");
+  const Package *added = addPackage(&after, "new", "1.0");
+
+  const IndexDiff diff(&before, &after);
+  REQUIRE(diff.changes().size() == 2);
+
+  REQUIRE(diff.changes()[0].type == IndexDiff::Added);
+  REQUIRE(diff.changes()[0].before == nullptr);
+  REQUIRE(diff.changes()[0].after == added);
+
+  REQUIRE(diff.changes()[1].type == IndexDiff::Removed);
+  REQUIRE(diff.changes()[1].before == removed);
+  REQUIRE(diff.changes()[1].after == nullptr);
+
+  REQUIRE(diff.changed(added));
+}
+
+TEST_CASE("diff modified packages", M) {
+  Index before("a"), after("a");
+
+  SECTION("new version") {
+    addPackage(&before, "pkg", "1.0");
+    const Package *pkg = addPackage(&after, "pkg", "1.1");
+
+    const IndexDiff diff(&before, &after);
+    REQUIRE(diff.changes().size() == 1);
+    REQUIRE(diff.changes()[0].type == IndexDiff::Modified);
+    REQUIRE(diff.changed(pkg));
+  }
+
+  SECTION("version name formatting") {
+    addPackage(&before, "pkg", "1");
+    addPackage(&after, "pkg", "1.0");
+
+    REQUIRE_FALSE(IndexDiff(&before, &after).empty());
+  }
+
+  SECTION("author") {
+    addPackage(&before, "pkg", "1.0", "a");
+    addPackage(&after, "pkg", "1.0", "b");
+
+    REQUIRE_FALSE(IndexDiff(&before, &after).empty());
+  }
+}
+
+TEST_CASE("diff without previous index", M) {
+  Index after("a");
+  const Package *pkg = addPackage(&after, "pkg", "1.0");
+
+  const IndexDiff diff(nullptr, &after);
+  REQUIRE(diff.changes().size() == 1);
+  REQUIRE(diff.changes()[0].type == IndexDiff::Added);
+  REQUIRE(diff.changed(pkg));
+}
@@ -284,6 +284,16 @@ TEST_CASE("read source type override", M) {
     == Package::EffectType);
 }
 
+TEST_CASE("read source hash", M) {
+  UseRootPath root(RIPATH);
+
+  IndexPtr ri = Index::load("src_hash");
+
+  CHECK(ri->packages().size() == 1);
+  REQUIRE(ri->category(0)->package(0)->version(0)->source(0)->checksum() ==
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
 TEST_CASE("read package description", M) {
   UseRootPath root(RIPATH);
 
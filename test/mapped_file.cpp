@@ -0,0 +1,24 @@
+#include "helper.hpp"
+
+#include <index.hpp>
+#include <mapped_file.hpp>
+
+static const char *M = "[mapped_file]";
+static const Path RIPATH("test/indexes");
+
+TEST_CASE("map file", M) {
+  UseRootPath root(RIPATH);
+
+  const MappedFile file(Index::pathFor("Новая папка"));
+  REQUIRE(file.isOpen());
+  REQUIRE(file.isTerminated());
+  REQUIRE(std::string(file.data(), file.size()) == "<index version=\"1\"/>\n");
+}
+
+TEST_CASE("map missing file", M) {
+  UseRootPath root(RIPATH);
+
+  const MappedFile file(Index::pathFor("404"));
+  REQUIRE_FALSE(file.isOpen());
+  REQUIRE(file.size() == 0);
+}
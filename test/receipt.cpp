@@ -146,6 +146,25 @@ TEST_CASE("format receipt page contents", M) {
   REQUIRE(page.contents() == "1\r\n2\r\n3");
 }
 
+TEST_CASE("downloads page", M) {
+  Receipt r;
+  r.addDownload({"https://fast/", 1024, 0.01, 0.02, 0.03, 0.04, 0.5});
+  r.addDownload({"https://slow/", 2048, 0.1, 0.2, 0.3, 0.4, 2});
+  REQUIRE(r.empty());
+
+  const ReceiptPage &page = r.downloadsPage();
+  REQUIRE(page.title() == "Downloads (2)");
+  REQUIRE(page.contents() ==
+    "https://slow/\r\n"
+    "  2.0 KB in 2000 ms (1.0 KB/s)\r\n"
+    "  name lookup 100 ms, connect 200 ms, TLS 300 ms, first byte 400 ms\r\n"
+    "\r\n"
+    "https://fast/\r\n"
+    "  1.0 KB in 500 ms (2.0 KB/s)\r\n"
+    "  name lookup 10 ms, connect 20 ms, TLS 30 ms, first byte 40 ms\r\n"
+  );
+}
+
 TEST_CASE("format install ticket", M) {
   IndexPtr ri = make_shared<Index>("Index Name");
   Category cat("Category Name", ri.get());
@@ -3,6 +3,7 @@
 #include <registry.hpp>
 
 #include <errors.hpp>
+#include <filesystem.hpp>
 #include <index.hpp>
 #include <package.hpp>
 #include <remote.hpp>
@@ -92,6 +93,45 @@ TEST_CASE("get file list", M) {
   REQUIRE(files[0].path == src->targetPath());
   REQUIRE(files[0].sections == 0);
   REQUIRE(files[0].type == pkg.type());
+  REQUIRE(files[0].size == 0);
+  REQUIRE(files[0].mtime == 0);
+  REQUIRE(files[0].hash.empty());
+}
+
+TEST_CASE("set file state", M) {
+  MAKE_PACKAGE
+
+  Registry reg;
+  const Registry::Entry &entry = reg.push(&ver);
+
+  Registry::File file = reg.getFiles(entry)[0];
+  file.size = 42;
+  file.mtime = 1234567890;
+  file.hash = "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad";
+  reg.setFileState(file);
+
+  const Registry::File stored = reg.getFiles(entry)[0];
+  REQUIRE(stored.size == file.size);
+  REQUIRE(stored.mtime == file.mtime);
+  REQUIRE(stored.hash == file.hash);
+
+  // reinstalling resets the state until the files are written again
+  reg.push(&ver);
+  REQUIRE(reg.getFiles(entry)[0].size == 0);
+}
+
+TEST_CASE("unchanged file state", M) {
+  UseRootPath root(Path("test/indexes"));
+
+  Registry::File file{Index::pathFor("Новая папка")};
+  REQUIRE_FALSE(file.isUnchanged()); // no recorded state
+
+  REQUIRE(FS::size(file.path, &file.size));
+  REQUIRE(FS::mtime(file.path, &file.mtime));
+  REQUIRE(file.isUnchanged());
+
+  file.size++;
+  REQUIRE_FALSE(file.isUnchanged());
 }
 
 TEST_CASE("query all packages", M) {
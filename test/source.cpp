@@ -130,6 +130,34 @@ TEST_CASE("empty source url", M) {
   }
 }
 
+TEST_CASE("source checksum", M) {
+  MAKE_VERSION;
+
+  Source source("filename", "url", &ver);
+  REQUIRE(source.checksum().empty());
+
+  source.setChecksum(
+    "BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD");
+  REQUIRE(source.checksum() ==
+    "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_CASE("invalid source checksum", M) {
+  MAKE_VERSION;
+
+  Source source("filename", "url", &ver);
+
+  try {
+    source.setChecksum("ba7816bf");
+    FAIL();
+  }
+  catch(const reapack_error &e) {
+    REQUIRE(string(e.what()) == "invalid source hash");
+  }
+
+  REQUIRE(source.checksum().empty());
+}
+
 TEST_CASE("source target path", M) {
   MAKE_VERSION;
 
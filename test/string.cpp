@@ -23,3 +23,11 @@ TEST_CASE("indent string", M) {
 
   REQUIRE(actual == "  line1\r\n  line2");
 }
+
+TEST_CASE("format size", M) {
+  REQUIRE(String::formatSize(0) == "0 B");
+  REQUIRE(String::formatSize(1023) == "1023 B");
+  REQUIRE(String::formatSize(1536) == "1.5 KB");
+  REQUIRE(String::formatSize(5 * 1024 * 1024) == "5.0 MB");
+  REQUIRE(String::formatSize(3LL * 1024 * 1024 * 1024) == "3.0 GB");
+}
@@ -35,6 +35,13 @@ TEST_CASE("out of range time string", M) {
   REQUIRE(time.toString() == string());
 }
 
+TEST_CASE("packed time", M) {
+  REQUIRE(Time(2016,1,2,3,4,5).packed() == Time(2016,1,2,3,4,5).packed());
+  REQUIRE(Time(2016,1,2,3,4,5).packed() < Time(2016,1,2,3,4,6).packed());
+  REQUIRE(Time(2016,12,31,23,59,59).packed() < Time(2017,1,1).packed());
+  REQUIRE(Time(2015,2,3).packed() < Time(2016,1,1).packed());
+}
+
 TEST_CASE("compare times", M) {
   SECTION("equality") {
     REQUIRE(Time(2016,1,2,3,4,5).compare(Time(2016,1,2,3,4,5)) == 0);
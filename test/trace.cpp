@@ -0,0 +1,28 @@
+#include "helper.hpp"
+
+#include <trace.hpp>
+
+#include <sstream>
+
+using namespace std;
+
+static const char *M = "[trace]";
+
+TEST_CASE("write trace events", M) {
+  {
+    Trace::Span span("test span", "a \"quoted\"\ndetail");
+  }
+
+  Trace::counter("test counter", 42);
+
+  ostringstream stream;
+  Trace::write(stream);
+  const string &json = stream.str();
+
+  REQUIRE(json.find("{\"traceEvents\":[") == 0);
+  REQUIRE(json.find("{\"name\":\"test span\",\"ph\":\"X\",") != string::npos);
+  REQUIRE(json.find("\"args\":{\"detail\":\"a \\\"quoted\\\"\\u000adetail\"}")
+    != string::npos);
+  REQUIRE(json.find("{\"name\":\"test counter\",\"ph\":\"C\",") != string::npos);
+  REQUIRE(json.find("\"args\":{\"test counter\":42}") != string::npos);
+}
@@ -0,0 +1,75 @@
+#include "helper.hpp"
+
+#include <trigram.hpp>
+
+using namespace std;
+
+static const char *M = "[trigram]";
+
+TEST_CASE("trigram index lookup", M) {
+  TrigramIndex ti;
+  ti.add(0, "Hello World");
+  ti.add(1, "world peace");
+  ti.add(2, "chunky bacon");
+
+  CHECK(ti.size() == 3);
+
+  vector<size_t> docs;
+
+  SECTION("match in one document") {
+    REQUIRE(ti.lookup("bacon", &docs));
+    REQUIRE(docs == vector<size_t>{2});
+  }
+
+  SECTION("match in several documents") {
+    REQUIRE(ti.lookup("world", &docs));
+    REQUIRE(docs == (vector<size_t>{0, 1}));
+  }
+
+  SECTION("case insensitive") {
+    REQUIRE(ti.lookup("HELLO", &docs));
+    REQUIRE(docs == vector<size_t>{0});
+  }
+
+  SECTION("no match") {
+    REQUIRE(ti.lookup("apple", &docs));
+    REQUIRE(docs.empty());
+  }
+
+  SECTION("every trigram must be present") {
+    REQUIRE(ti.lookup("hello peace", &docs));
+    REQUIRE(docs.empty());
+  }
+
+  SECTION("too short") {
+    REQUIRE_FALSE(ti.lookup("he", &docs));
+    REQUIRE(docs.empty());
+  }
+}
+
+TEST_CASE("trigram index with multiple values per document", M) {
+  TrigramIndex ti;
+  ti.add(0, "hello");
+  ti.add(0, "world");
+  ti.add(1, "hello hello");
+
+  vector<size_t> docs;
+  REQUIRE(ti.lookup("hello", &docs));
+  REQUIRE(docs == (vector<size_t>{0, 1}));
+
+  // trigrams never span across two values of the same document
+  REQUIRE(ti.lookup("lowor", &docs));
+  REQUIRE(docs.empty());
+}
+
+TEST_CASE("clear trigram index", M) {
+  TrigramIndex ti;
+  ti.add(0, "hello");
+  ti.clear();
+
+  REQUIRE(ti.size() == 0);
+
+  vector<size_t> docs;
+  REQUIRE(ti.lookup("hello", &docs));
+  REQUIRE(docs.empty());
+}
@@ -170,6 +170,33 @@ TEST_CASE("compare versions with more or less segments", M) {
   REQUIRE(VersionName("1.0.0.1") != VersionName("1"));
 }
 
+TEST_CASE("packed version", M) {
+  uint64_t key;
+
+  SECTION("numeric") {
+    REQUIRE(VersionName("1.2.3.4").packed(&key));
+    REQUIRE(key == 0x0001000200030004);
+  }
+
+  SECTION("missing segments") {
+    REQUIRE(VersionName("1").packed(&key));
+    REQUIRE(key == 0x0001000000000000);
+  }
+
+  SECTION("ordered like compare") {
+    uint64_t other;
+    REQUIRE(VersionName("1.10").packed(&key));
+    REQUIRE(VersionName("1.9.65535").packed(&other));
+    REQUIRE(key > other);
+  }
+
+  SECTION("unpackable") {
+    REQUIRE_FALSE(VersionName().packed(&key));
+    REQUIRE_FALSE(VersionName("1.0-beta").packed(&key));
+    REQUIRE_FALSE(VersionName("1.2.3.4.5").packed(&key));
+  }
+}
+
 TEST_CASE("prerelease versions", M) {
   SECTION("detect") {
     REQUIRE(VersionName("1.0").isStable());